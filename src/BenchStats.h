@@ -0,0 +1,35 @@
+#ifndef BENCHSTATS_H
+#define BENCHSTATS_H
+
+#include <QJsonObject>
+#include <algorithm>
+#include <vector>
+
+// Resumo de tempos em ms para o JSON das ferramentas headless
+// (ptz_bench, ptz_batch): contagem, média, p50/p95/p99 e máximo.
+namespace BenchStats {
+
+inline double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = (size_t)std::min<double>(sorted.size() - 1, p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[idx];
+}
+
+inline QJsonObject summarize(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double v : samples) sum += v;
+
+    QJsonObject obj;
+    obj["count"] = (int)samples.size();
+    obj["mean_ms"] = samples.empty() ? 0.0 : sum / samples.size();
+    obj["p50_ms"] = percentile(samples, 50);
+    obj["p95_ms"] = percentile(samples, 95);
+    obj["p99_ms"] = percentile(samples, 99);
+    obj["max_ms"] = samples.empty() ? 0.0 : samples.back();
+    return obj;
+}
+
+}
+
+#endif
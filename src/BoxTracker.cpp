@@ -0,0 +1,134 @@
+#include "BoxTracker.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+float median(std::vector<float>& values) {
+    size_t mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    return values[mid];
+}
+
+}
+
+BoxTracker::BoxTracker()
+    : gridSize(8), maxFBError(1.5f), minTrackedRatio(0.5f)
+{
+}
+
+void BoxTracker::toGray(const cv::Mat& frame, cv::Mat& gray) {
+    if (frame.channels() == 3) {
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        frame.copyTo(gray);
+    }
+}
+
+void BoxTracker::reset() {
+    boxes.clear();
+}
+
+void BoxTracker::init(const cv::Mat& frame, const std::vector<Detection>& detections) {
+    boxes = detections;
+    toGray(frame, prevGray);
+}
+
+bool BoxTracker::update(const cv::Mat& frame, std::vector<Detection>& detections) {
+    if (boxes.empty() || prevGray.empty()) {
+        return false;
+    }
+    
+    toGray(frame, currGray);
+    
+    // Grade de pontos dentro de cada caixa (margem de 10%)
+    prevPoints.clear();
+    pointOwner.clear();
+    cv::Rect bounds(0, 0, prevGray.cols, prevGray.rows);
+    for (size_t b = 0; b < boxes.size(); b++) {
+        cv::Rect r = boxes[b].bbox & bounds;
+        if (r.width < 4 || r.height < 4) continue;
+        
+        float mx = r.width * 0.1f, my = r.height * 0.1f;
+        float stepX = (r.width - 2 * mx) / (gridSize - 1);
+        float stepY = (r.height - 2 * my) / (gridSize - 1);
+        for (int gy = 0; gy < gridSize; gy++) {
+            for (int gx = 0; gx < gridSize; gx++) {
+                prevPoints.emplace_back(r.x + mx + gx * stepX, r.y + my + gy * stepY);
+                pointOwner.push_back((int)b);
+            }
+        }
+    }
+    
+    if (prevPoints.empty()) {
+        boxes.clear();
+        return false;
+    }
+    
+    // Fluxo ida e volta: descarta pontos com erro forward-backward alto
+    cv::calcOpticalFlowPyrLK(prevGray, currGray, prevPoints, nextPoints, status, errors);
+    cv::calcOpticalFlowPyrLK(currGray, prevGray, nextPoints, backPoints, backStatus, errors);
+    
+    std::vector<Detection> tracked;
+    std::vector<float> dxs, dys, scales;
+    bool healthy = true;
+    
+    for (size_t b = 0; b < boxes.size(); b++) {
+        dxs.clear();
+        dys.clear();
+        int total = 0;
+        cv::Point2f prevCenter(0, 0), nextCenter(0, 0);
+        
+        for (size_t i = 0; i < prevPoints.size(); i++) {
+            if (pointOwner[i] != (int)b) continue;
+            total++;
+            if (!status[i] || !backStatus[i]) continue;
+            cv::Point2f fb = prevPoints[i] - backPoints[i];
+            if (fb.dot(fb) > maxFBError * maxFBError) continue;
+            
+            dxs.push_back(nextPoints[i].x - prevPoints[i].x);
+            dys.push_back(nextPoints[i].y - prevPoints[i].y);
+            prevCenter += prevPoints[i];
+            nextCenter += nextPoints[i];
+        }
+        
+        float ratio = total ? (float)dxs.size() / total : 0.0f;
+        if (ratio < minTrackedRatio || dxs.size() < 4) {
+            healthy = false;
+            continue; // Caixa perdida
+        }
+        
+        // Escala: razão mediana das distâncias ao centróide
+        float n = (float)dxs.size();
+        prevCenter *= 1.0f / n;
+        nextCenter *= 1.0f / n;
+        scales.clear();
+        for (size_t i = 0; i < prevPoints.size(); i++) {
+            if (pointOwner[i] != (int)b) continue;
+            if (!status[i] || !backStatus[i]) continue;
+            cv::Point2f fb = prevPoints[i] - backPoints[i];
+            if (fb.dot(fb) > maxFBError * maxFBError) continue;
+            
+            float d0 = (float)cv::norm(prevPoints[i] - prevCenter);
+            float d1 = (float)cv::norm(nextPoints[i] - nextCenter);
+            if (d0 > 1.0f) scales.push_back(d1 / d0);
+        }
+        float scale = scales.empty() ? 1.0f : std::clamp(median(scales), 0.8f, 1.25f);
+        float dx = median(dxs);
+        float dy = median(dys);
+        
+        Detection det = boxes[b];
+        float cx = det.bbox.x + det.bbox.width / 2.0f + dx;
+        float cy = det.bbox.y + det.bbox.height / 2.0f + dy;
+        float w = det.bbox.width * scale;
+        float h = det.bbox.height * scale;
+        det.bbox = cv::Rect(cvRound(cx - w / 2), cvRound(cy - h / 2), cvRound(w), cvRound(h));
+        tracked.push_back(det);
+    }
+    
+    boxes = tracked;
+    detections = tracked;
+    std::swap(prevGray, currGray);
+    
+    return healthy && !boxes.empty();
+}
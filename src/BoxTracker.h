@@ -0,0 +1,40 @@
+#ifndef BOXTRACKER_H
+#define BOXTRACKER_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "YOLODetector.h"
+
+// Rastreador leve entre keyframes: propaga as caixas do YOLO com fluxo
+// óptico esparso (median flow) sobre uma grade de pontos em cada caixa.
+class BoxTracker {
+public:
+    BoxTracker();
+    
+    void init(const cv::Mat& frame, const std::vector<Detection>& detections);
+    // Atualiza as caixas para o novo frame (a confiança é a do keyframe);
+    // false quando o rastreio degradou: poucos pontos sobreviveram ao
+    // teste de erro forward-backward
+    bool update(const cv::Mat& frame, std::vector<Detection>& detections);
+    void reset();
+    bool isActive() const { return !boxes.empty(); }
+
+private:
+    void toGray(const cv::Mat& frame, cv::Mat& gray);
+    
+    cv::Mat prevGray;
+    cv::Mat currGray;
+    std::vector<Detection> boxes;
+    
+    // Buffers reutilizados a cada frame
+    std::vector<cv::Point2f> prevPoints, nextPoints, backPoints;
+    std::vector<uchar> status, backStatus;
+    std::vector<float> errors;
+    std::vector<int> pointOwner;
+    
+    int gridSize;
+    float maxFBError;
+    float minTrackedRatio;
+};
+
+#endif
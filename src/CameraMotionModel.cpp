@@ -0,0 +1,51 @@
+#include "CameraMotionModel.h"
+
+namespace {
+
+// Histórico mantido: cobre com folga a idade máxima de uma observação
+const double kHistorySeconds = 5.0;
+
+}
+
+void CameraMotionModel::reset() {
+    segments.clear();
+}
+
+void CameraMotionModel::command(double t, float panSpeed, float tiltSpeed) {
+    if (segments.empty()) {
+        segments.push_back({t, panSpeed, tiltSpeed, 0.0, 0.0});
+        return;
+    }
+    
+    const Segment& last = segments.back();
+    if (last.x == panSpeed && last.y == tiltSpeed) return;
+    if (t < last.t) t = last.t; // Atraso estimado diminuiu: não reescreve o passado
+    
+    double sx, sy;
+    shiftAt(t, sx, sy);
+    segments.push_back({t, panSpeed, tiltSpeed, sx, sy});
+    
+    while (segments.size() > 2 && segments[1].t < t - kHistorySeconds) {
+        segments.pop_front();
+    }
+}
+
+void CameraMotionModel::shiftAt(double t, double& sx, double& sy) const {
+    sx = sy = 0.0;
+    if (segments.empty()) return;
+    
+    // Antes do primeiro comando a câmera estava parada
+    if (t <= segments.front().t) {
+        sx = segments.front().sx;
+        sy = segments.front().sy;
+        return;
+    }
+    
+    for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+        if (it->t <= t) {
+            sx = it->sx + it->x * (t - it->t);
+            sy = it->sy + it->y * (t - it->t);
+            return;
+        }
+    }
+}
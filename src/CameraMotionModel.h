@@ -0,0 +1,27 @@
+#ifndef CAMERAMOTIONMODEL_H
+#define CAMERAMOTIONMODEL_H
+
+#include <deque>
+
+// Histórico dos comandos de velocidade enviados à cabeça PTZ, integrado
+// no tempo: diz quanto a câmera girou (em velocidade VISCA x segundos)
+// entre dois instantes, para descontar o movimento próprio da câmera.
+class CameraMotionModel {
+public:
+    void reset();
+    // Velocidade que passa a valer em t (envio + atraso de atuação)
+    void command(double t, float panSpeed, float tiltSpeed);
+    // Deslocamento acumulado até t (o último comando continua valendo)
+    void shiftAt(double t, double& sx, double& sy) const;
+
+private:
+    struct Segment {
+        double t;
+        float x, y;    // velocidade no trecho
+        double sx, sy; // deslocamento acumulado no início do trecho
+    };
+    
+    std::deque<Segment> segments;
+};
+
+#endif
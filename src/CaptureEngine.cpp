@@ -2,37 +2,72 @@
 #include <chrono>
 #include <thread>
 #include <cmath>
+#include <algorithm>
+#include <stdexcept>
 
-CaptureEngine::CaptureEngine(const std::string& source, int fps, float threshold)
+namespace {
+
+uint64_t elapsedUs(std::chrono::steady_clock::time_point since) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - since).count();
+}
+
+// Base de tempo do TrackingController (segundos do steady_clock)
+double toSeconds(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double>(t.time_since_epoch()).count();
+}
+
+StageLatency toStageLatency(const LatencyHistogram::Snapshot& snap) {
+    StageLatency stage;
+    stage.count = (int)snap.count;
+    stage.p50Ms = snap.percentileMs(50);
+    stage.p95Ms = snap.percentileMs(95);
+    stage.p99Ms = snap.percentileMs(99);
+    stage.maxMs = snap.maxUs / 1000.0;
+    return stage;
+}
+
+}
+
+CaptureEngine::CaptureEngine(const std::string& source, int fps, float threshold,
+                             const BackendConfig& backendConfig,
+                             std::shared_ptr<InferenceService> inferenceService)
     : videoSource(source), targetFPS(fps), confThreshold(threshold), 
-      running(false), captureThread(nullptr), autoTracking(false),
-      // PID state
-      integral_x(0), integral_y(0), prev_err_x(0), prev_err_y(0),
-      filtered_derivative_x(0), filtered_derivative_y(0),
-      prev_ptz_speed_x(0), prev_ptz_speed_y(0),
-      last_nx(0.5), last_ny(0.5), last_nz(0),
-      lost_frames(0), manual_mode(false),
-      manual_target_x(0.5), manual_target_y(0.5)
+      running(false), autoTracking(false),
+      grabThread(nullptr), inferThread(nullptr),
+      controlThread(nullptr), renderThread(nullptr),
+      inferenceService(std::move(inferenceService)), keyframeInterval(1), motionGateEnabled(false), gatedFrames(0),
+      roiMode(false), hint_valid(false), hint_nx(0.5f), hint_ny(0.5f), hint_nz(0), hint_locked_id(-1),
+      framesSinceFullScan(0), inferBudgetMs(0), lastInputSize(0), inputHintPx(0), controlRateHz(50), actuationDelayMs(0), zoomEstimate(1), lastZoomSpeed(0)
 {
-    detector = std::make_unique<YOLODetector>("yolov8n.onnx", threshold);
+    qRegisterMetaType<PipelineTelemetry>("PipelineTelemetry");
+    qRegisterMetaType<FrameOverlay>("FrameOverlay");
+    
+    // O detector entrega também as caixas fracas: a 2ª etapa do
+    // objectTracker as usa para segurar trilhas (oclusão, blur)
+    if (this->inferenceService) {
+        this->inferenceService->setConfidenceThreshold(objectTracker.low_thresh);
+        this->inferenceService->setInputSizes({256, 320, 416, 640});
+    } else {
+        detector = std::make_unique<YOLODetector>("yolov8n.onnx", objectTracker.low_thresh, backendConfig);
+        detector->setInputSizes({256, 320, 416, 640});
+    }
+    framePool = FramePool::create(4);
     
-    // Parâmetros de controle
-    conf_min = 0.5f;
-    nz_min = 0.02f;
-    deadband = 0.03f;
+    // Câmera virtual: criada aqui para que o PTZController ("sim") a encontre
+    if (source.rfind("sim:", 0) == 0) {
+        simCamera = std::make_shared<VirtualPTZCamera>();
+        if (!simCamera->open(source.substr(4))) {
+            throw std::runtime_error("Falha ao abrir a fonte simulada " + source.substr(4));
+        }
+        VirtualPTZCamera::setActive(simCamera);
+    }
     
-    Kp_x = 1.2f; Ki_x = 0.05f; Kd_x = 0.06f;
-    Kp_y = 1.0f; Ki_y = 0.05f; Kd_y = 0.05f;
-    I_max = 0.5f;
+    roi_margin = 3.0f;
+    roi_full_scan_interval = 30;
     
-    gamma = 0.8f;
-    near_edge_threshold = 0.15f;
-    approach_limit = 0.05f;
-    v_thresh = 0.02f;
-    slew_rate = 0.6f;
-    lpf_tau = 0.08f;
-    stop_threshold = 0.02f;
-    lost_max_frames = 15;
+    zoom_rate_max = 1.2f;
+    zoom_max = 10.0f;
 }
 
 CaptureEngine::~CaptureEngine() {
@@ -41,352 +76,569 @@ CaptureEngine::~CaptureEngine() {
 
 void CaptureEngine::setConfidenceThreshold(float threshold) {
     confThreshold = threshold;
-    if (detector) {
-        detector->setConfidenceThreshold(threshold);
-    }
 }
 
 void CaptureEngine::setAutoTracking(bool enabled) {
     autoTracking = enabled;
     if (enabled) {
-        resetPIDState();
+        std::lock_guard<std::mutex> lock(controllerMutex);
+        controller.reset();
+        if (auto recorder = activeRecorder()) {
+            recorder->recordReset(SessionRecorder::now());
+        }
+    } else if (lastZoomSpeed.exchange(0) != 0) {
+        emit zoomAdjustmentNeeded(0); // O laço de controle para: não deixa o zoom correndo
     }
 }
 
-void CaptureEngine::setManualTarget(float x, float y) {
-    manual_mode = true;
-    manual_target_x = x;
-    manual_target_y = y;
-    resetPIDState();
+void CaptureEngine::setKeyframeInterval(int frames) {
+    keyframeInterval = std::max(1, frames);
+}
+
+void CaptureEngine::setMotionGate(bool enabled) {
+    motionGateEnabled = enabled;
+}
+
+void CaptureEngine::setCaptureConfig(const CaptureConfig& config) {
+    captureConfig = config;
+}
+
+void CaptureEngine::setRoiMode(bool enabled) {
+    roiMode = enabled;
 }
 
-void CaptureEngine::resetPIDState() {
-    integral_x = 0;
-    integral_y = 0;
-    prev_err_x = 0;
-    prev_err_y = 0;
-    filtered_derivative_x = 0;
-    filtered_derivative_y = 0;
-    prev_ptz_speed_x = 0;
-    prev_ptz_speed_y = 0;
-    lost_frames = 0;
+void CaptureEngine::setControlRate(int hz) {
+    controlRateHz = std::clamp(hz, 10, 200);
+}
+
+void CaptureEngine::setInferenceBudget(double ms) {
+    inferBudgetMs = std::max(0.0, ms);
+}
+
+void CaptureEngine::setAutoZoom(bool enabled) {
+    std::lock_guard<std::mutex> lock(controllerMutex);
+    controller.auto_zoom = enabled;
+}
+
+void CaptureEngine::setRecorder(std::shared_ptr<SessionRecorder> recorder) {
+    // O replay parte de um TrackingController novo: a gravação começa com o
+    // controle zerado e um Reset, sob o mesmo lock de observe/step
+    std::lock_guard<std::mutex> controlLock(controllerMutex);
+    if (recorder) {
+        controller.reset();
+        recorder->recordReset(SessionRecorder::now());
+    }
+    std::lock_guard<std::mutex> lock(recorderMutex);
+    sessionRecorder = std::move(recorder);
+}
+
+std::shared_ptr<SessionRecorder> CaptureEngine::activeRecorder() {
+    std::lock_guard<std::mutex> lock(recorderMutex);
+    return sessionRecorder;
+}
+
+void CaptureEngine::setActuationDelay(double ms) {
+    std::lock_guard<std::mutex> lock(controllerMutex);
+    actuationDelayMs = actuationDelayMs > 0 ? 0.9 * actuationDelayMs + 0.1 * ms : ms;
+    controller.actuation_delay = (float)(actuationDelayMs / 1000.0);
+}
+
+void CaptureEngine::setManualTarget(float x, float y) {
+    std::lock_guard<std::mutex> lock(controllerMutex);
+    controller.setManualTarget(x, y);
+    if (auto recorder = activeRecorder()) {
+        recorder->recordManual(SessionRecorder::now(), x, y);
+    }
 }
 
 void CaptureEngine::start() {
     if (running) return;
     running = true;
     
-    captureThread = QThread::create([this]() { captureLoop(); });
-    captureThread->start();
+    inferQueue.reset();
+    controlQueue.reset();
+    renderQueue.reset();
+    
+    grabThread = QThread::create([this]() { grabLoop(); });
+    inferThread = QThread::create([this]() { inferLoop(); });
+    controlThread = QThread::create([this]() { controlLoop(); });
+    renderThread = QThread::create([this]() { renderLoop(); });
+    
+    grabThread->start();
+    inferThread->start();
+    controlThread->start();
+    renderThread->start();
 }
 
 void CaptureEngine::stop() {
     running = false;
-    if (captureThread) {
-        captureThread->wait();
-        delete captureThread;
-        captureThread = nullptr;
+    
+    // Fechar as filas acorda os estágios bloqueados em pop()
+    inferQueue.close();
+    controlQueue.close();
+    renderQueue.close();
+    
+    for (QThread** thread : {&grabThread, &inferThread, &controlThread, &renderThread}) {
+        if (*thread) {
+            (*thread)->wait();
+            delete *thread;
+            *thread = nullptr;
+        }
     }
 }
 
-void CaptureEngine::captureLoop() {
+void CaptureEngine::grabLoop() {
+    if (simCamera) {
+        simGrabLoop();
+        return;
+    }
+    
     cv::VideoCapture cap;
+    bool isDevice = true;
     
     try {
         int deviceId = std::stoi(videoSource);
+#ifdef __linux__
+        cap.open(deviceId, cv::CAP_V4L2); // CONVERT_RGB=false só vale no V4L2
+#else
         cap.open(deviceId);
+#endif
     } catch (...) {
+        isDevice = false;
         cap.open(videoSource);
     }
     
     if (!cap.isOpened()) {
+        running = false;
+        inferQueue.close();
         return;
     }
     
-    cap.set(cv::CAP_PROP_FRAME_WIDTH, 640);
-    cap.set(cv::CAP_PROP_FRAME_HEIGHT, 480);
+    // Formato nativo: o fourcc precisa ser pedido antes da resolução
+    FrameDecoder decoder;
+    if (isDevice) {
+        FrameDecoder::Format wanted = FrameDecoder::fromName(
+            captureConfig.pixelFormat, captureConfig.resolution, captureConfig.processWidth);
+        if (wanted != FrameDecoder::Format::BGR) {
+            cap.set(cv::CAP_PROP_FOURCC, FrameDecoder::toFourcc(wanted));
+        }
+        cap.set(cv::CAP_PROP_FRAME_WIDTH, captureConfig.resolution.width);
+        cap.set(cv::CAP_PROP_FRAME_HEIGHT, captureConfig.resolution.height);
+    }
+    cap.set(cv::CAP_PROP_BUFFERSIZE, 1);
+    
+    // Buffer bruto para o FrameDecoder; sem suporte, o OpenCV converte para BGR
+    cv::Size sourceSize((int)cap.get(cv::CAP_PROP_FRAME_WIDTH), (int)cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+    FrameDecoder::Format negotiated = isDevice
+        ? FrameDecoder::fromFourcc((int)cap.get(cv::CAP_PROP_FOURCC)) : FrameDecoder::Format::BGR;
+    bool rawDecode = negotiated != FrameDecoder::Format::BGR && cap.set(cv::CAP_PROP_CONVERT_RGB, 0);
+    if (rawDecode) {
+        decoder.configure(negotiated, sourceSize, captureConfig.processWidth);
+    }
+    {
+        std::lock_guard<std::mutex> lock(ingestMutex);
+        ingestInfo = QString("%1 %2x%3 (1/%4)")
+            .arg(FrameDecoder::name(rawDecode ? negotiated : FrameDecoder::Format::BGR))
+            .arg(sourceSize.width).arg(sourceSize.height).arg(decoder.scale());
+    }
     
-    double frameTime = 1000.0 / targetFPS;
-    auto lastFpsTime = std::chrono::steady_clock::now();
-    auto lastFrameTime = std::chrono::steady_clock::now();
-    int frameCounter = 0;
+    auto frameInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / targetFPS));
+    auto nextFrameTime = std::chrono::steady_clock::now();
+    uint64_t sequence = 0;
     
     while (running) {
-        auto startTime = std::chrono::steady_clock::now();
-        auto now = std::chrono::steady_clock::now();
-        float dt = std::chrono::duration<float>(now - lastFrameTime).count();
-        lastFrameTime = now;
-        
-        cv::Mat frame;
-        if (!cap.read(frame)) {
+        // grab() apenas retira o buffer do driver; a decodificação
+        // só acontece em retrieve() para os frames que serão usados
+        if (!cap.grab()) {
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
             continue;
         }
         
-        auto detections = detector->detect(frame);
-        drawDetections(frame, detections);
-        
-        // Controle PTZ avançado
-        if (autoTracking || manual_mode) {
-            processPTZControl(frame, detections, dt);
+        auto now = std::chrono::steady_clock::now();
+        if (now + frameInterval / 4 < nextFrameTime) {
+            if (isDevice) {
+                continue; // Câmera: drena o buffer V4L2 sem decodificar
+            }
+            std::this_thread::sleep_until(nextFrameTime); // Arquivo: respeita o FPS
+            now = std::chrono::steady_clock::now();
         }
+        nextFrameTime = now + frameInterval;
         
-        emit frameReady(matToQImage(frame));
-        emit detectionCount(detections.size());
-        
-        frameCounter++;
-        auto elapsed = std::chrono::duration<double>(now - lastFpsTime).count();
-        
-        if (elapsed >= 1.0) {
-            double fps = frameCounter / elapsed;
-            emit fpsUpdated(fps);
-            frameCounter = 0;
-            lastFpsTime = now;
+        FramePacket packet;
+        if (rawDecode) {
+            cv::Mat raw; // Por frame: o BGR de fallback referencia este buffer
+            if (!cap.retrieve(raw) || !decoder.decode(raw, packet.frame)) {
+                continue;
+            }
+        } else if (!cap.retrieve(packet.frame) || packet.frame.empty()) {
+            continue;
         }
+        packet.sequence = sequence++;
+        packet.captureTime = now;
+        captureLatency.record(elapsedUs(now));
         
-        auto processingTime = std::chrono::steady_clock::now() - startTime;
-        auto waitTime = std::chrono::milliseconds((int)frameTime) - 
-                       std::chrono::duration_cast<std::chrono::milliseconds>(processingTime);
-        
-        if (waitTime.count() > 0) {
-            std::this_thread::sleep_for(waitTime);
-        }
+        inferQueue.push(std::move(packet));
     }
     
     cap.release();
+    inferQueue.close();
 }
 
-void CaptureEngine::processPTZControl(const cv::Mat& frame, 
-                                      const std::vector<Detection>& detections, 
-                                      float dt) {
-    float nx, ny, nz;
-    bool target_found = false;
+void CaptureEngine::simGrabLoop() {
+    auto frameInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / targetFPS));
+    auto lastFrameTime = std::chrono::steady_clock::now();
+    auto nextFrameTime = lastFrameTime;
+    uint64_t sequence = 0;
     
-    if (manual_mode) {
-        // Modo manual: usar coordenada do clique
-        nx = manual_target_x;
-        ny = manual_target_y;
-        nz = 0.1f;
-        target_found = true;
-    } else if (!detections.empty()) {
-        // Auto mode: selecionar melhor alvo
-        Detection bestTarget = selectBestTarget(frame, detections);
+    while (running) {
+        std::this_thread::sleep_until(nextFrameTime);
+        auto now = std::chrono::steady_clock::now();
+        nextFrameTime = now + frameInterval;
         
-        if (bestTarget.confidence >= conf_min) {
-            // Normalizar bbox
-            float cx = bestTarget.bbox.x + bestTarget.bbox.width / 2.0f;
-            float cy = bestTarget.bbox.y + bestTarget.bbox.height / 2.0f;
-            float diag = std::sqrt(frame.cols * frame.cols + frame.rows * frame.rows);
-            
-            nx = cx / frame.cols;
-            ny = cy / frame.rows;
-            nz = std::sqrt(bestTarget.bbox.width * bestTarget.bbox.height) / diag;
-            
-            if (nz >= nz_min) {
-                target_found = true;
-                last_nx = nx;
-                last_ny = ny;
-                last_nz = nz;
-                lost_frames = 0;
-            }
+        // O tempo simulado acompanha o relógio real
+        double dt = std::chrono::duration<double>(now - lastFrameTime).count();
+        lastFrameTime = now;
+        
+        FramePacket packet;
+        if (!simCamera->read(packet.frame, dt)) {
+            break;
         }
+        packet.sequence = sequence++;
+        packet.captureTime = now;
+        captureLatency.record(elapsedUs(now));
+        
+        inferQueue.push(std::move(packet));
     }
     
-    if (!target_found) {
-        lost_frames++;
-        
-        if (lost_frames < lost_max_frames) {
-            // Manter último comando com decaimento
-            integral_x *= 0.95f;
-            integral_y *= 0.95f;
-            nx = last_nx;
-            ny = last_ny;
-        } else {
-            // Alvo perdido - parar
-            if (autoTracking) {
-                emit ptzAdjustmentNeeded(0, 0);
-            }
-            return;
+    inferQueue.close();
+}
+
+std::vector<Detection> CaptureEngine::runDetector(const cv::Mat& frame) {
+    if (inferenceService) {
+        // O frame é só lido pelo worker enquanto esta thread espera o lote
+        auto result = inferenceService->submit(frame, inputHintPx, inferBudgetMs).get();
+        lastInputSize = result.inputSize;
+        return std::move(result.detections);
+    }
+    auto detections = detector->detect(frame);
+    lastInputSize = detector->lastTimings().inputSize;
+    return detections;
+}
+
+void CaptureEngine::updateInputHint(const cv::Size& frameSize) {
+    // Alvo grande passa pela entrada menor; sem alvo, a maior que cabe no orçamento
+    float pixels = 0;
+    {
+        std::lock_guard<std::mutex> lock(targetHintMutex);
+        if (hint_valid) {
+            pixels = hint_nz * std::sqrt((float)(frameSize.width * frameSize.width +
+                                                 frameSize.height * frameSize.height));
         }
     }
-    
-    // Calcular erro normalizado
-    float err_x = nx - 0.5f;
-    float err_y = ny - 0.5f;
-    float err_mag = std::sqrt(err_x * err_x + err_y * err_y);
-    
-    // Modo manual: parar quando próximo do alvo
-    if (manual_mode && err_mag < stop_threshold) {
-        manual_mode = false;
-        emit ptzAdjustmentNeeded(0, 0);
+    if (inferenceService) {
+        inputHintPx = pixels; // A entrada do lote é escolhida pelo serviço
         return;
     }
+    detector->setLatencyBudget(inferBudgetMs);
+    detector->setTargetHint(pixels);
+}
+
+bool CaptureEngine::computeRoi(const cv::Size& frameSize, cv::Rect& roi) {
+    float nx, ny, nz;
+    {
+        std::lock_guard<std::mutex> lock(targetHintMutex);
+        if (!hint_valid) return false;
+        nx = hint_nx;
+        ny = hint_ny;
+        nz = hint_nz;
+    }
     
-    // Aplicar deadband
-    float err_x_eff = applyDeadband(err_x);
-    float err_y_eff = applyDeadband(err_y);
-    
-    // Calcular distâncias às bordas
-    float dist_x_edge = std::min(nx, 1.0f - nx);
-    float dist_y_edge = std::min(ny, 1.0f - ny);
-    
-    // Estimar velocidade do alvo
-    float v_target_x = (err_x - prev_err_x) / (dt + 1e-6f);
-    float v_target_y = (err_y - prev_err_y) / (dt + 1e-6f);
-    
-    // Calcular PID para X
-    float u_p_x = Kp_x * err_x_eff;
-    integral_x += Ki_x * err_x_eff * dt;
-    integral_x = std::clamp(integral_x, -I_max, I_max);
-    
-    float derivative_x = (err_x_eff - prev_err_x) / (dt + 1e-6f);
-    float alpha_d = std::exp(-dt / lpf_tau);
-    filtered_derivative_x = alpha_d * filtered_derivative_x + (1 - alpha_d) * derivative_x;
-    float u_d_x = Kd_x * filtered_derivative_x;
-    
-    float raw_speed_x = u_p_x + integral_x + u_d_x;
-    
-    // Calcular PID para Y
-    float u_p_y = Kp_y * err_y_eff;
-    integral_y += Ki_y * err_y_eff * dt;
-    integral_y = std::clamp(integral_y, -I_max, I_max);
-    
-    float derivative_y = (err_y_eff - prev_err_y) / (dt + 1e-6f);
-    filtered_derivative_y = alpha_d * filtered_derivative_y + (1 - alpha_d) * derivative_y;
-    float u_d_y = Kd_y * filtered_derivative_y;
-    
-    float raw_speed_y = u_p_y + integral_y + u_d_y;
-    
-    // Aplicar não-linearidade (suavização)
-    float speed_factor_x = applyNonLinearity(raw_speed_x);
-    float speed_factor_y = applyNonLinearity(raw_speed_y);
+    // Lado do recorte: margem sobre o tamanho do alvo, nunca menor que a
+    // entrada que a rede vai usar neste frame (o recorte entra em
+    // resolução nativa mesmo quando a entrada adaptativa troca de tamanho)
+    float diag = std::sqrt((float)(frameSize.width * frameSize.width +
+                                   frameSize.height * frameSize.height));
+    cv::Size input = inferenceService ? inferenceService->upcomingInputSize(inferBudgetMs)
+                                      : detector->upcomingInputSize(frameSize);
+    int minSide = std::max(input.width, input.height);
+    int maxSide = std::min(frameSize.width, frameSize.height);
+    int side = std::max(minSide, (int)(roi_margin * nz * diag));
+    
+    if (side >= maxSide) {
+        return false; // Recorte não economiza nada
+    }
     
-    // Mapear para range PTZ [1, 2]
-    float ptz_speed_x_target = 1.0f + speed_factor_x * 1.0f;
-    float ptz_speed_y_target = 1.0f + speed_factor_y * 1.0f;
+    int x = (int)(nx * frameSize.width) - side / 2;
+    int y = (int)(ny * frameSize.height) - side / 2;
+    x = std::clamp(x, 0, frameSize.width - side);
+    y = std::clamp(y, 0, frameSize.height - side);
+    roi = cv::Rect(x, y, side, side);
+    return true;
+}
+
+std::vector<Detection> CaptureEngine::detectWithRoi(const cv::Mat& frame) {
+    cv::Rect roi;
     
-    // Regras dinâmicas near-edge
-    if (dist_x_edge <= near_edge_threshold) {
-        if (dist_x_edge <= approach_limit && std::abs(v_target_x) > v_thresh) {
-            ptz_speed_x_target = 2.0f; // Aceleração de recuperação
-        } else {
-            ptz_speed_x_target = std::max(1.0f, ptz_speed_x_target * 0.7f);
+    if (roiMode && framesSinceFullScan < roi_full_scan_interval &&
+        computeRoi(frame.size(), roi)) {
+        auto detections = runDetector(frame(roi));
+        
+        if (!detections.empty()) {
+            for (auto& det : detections) {
+                det.bbox.x += roi.x;
+                det.bbox.y += roi.y;
+            }
+            framesSinceFullScan++;
+            return detections;
         }
+        // Alvo não está no recorte: varredura completa neste mesmo frame
     }
     
-    if (dist_y_edge <= near_edge_threshold) {
-        if (dist_y_edge <= approach_limit && std::abs(v_target_y) > v_thresh) {
-            ptz_speed_y_target = 2.0f;
+    framesSinceFullScan = 0;
+    return runDetector(frame);
+}
+
+void CaptureEngine::inferLoop() {
+    FramePacket packet;
+    int framesSinceKeyframe = 0;
+    framesSinceFullScan = 0;
+    boxTracker.reset();
+    objectTracker.reset();
+    motionGate.reset();
+    // Câmera ativa enquanto esta thread roda: o serviço espera o frame dela no lote
+    if (inferenceService) inferenceService->registerClient();
+    
+    // Sempre processa o frame mais recente; os antigos são descartados na fila
+    while (inferQueue.pop(packet)) {
+        auto inferStart = std::chrono::steady_clock::now();
+        if (auto recorder = activeRecorder()) {
+            recorder->recordFrame(toSeconds(packet.captureTime), packet.sequence, packet.frame);
+        }
+        queueLatency.record((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            inferStart - packet.captureTime).count());
+        
+        int interval = keyframeInterval;
+        bool keyframe = interval <= 1 || framesSinceKeyframe + 1 >= interval;
+        if (interval <= 1) {
+            // Sem keyframes o rastreador leve não é atualizado: caixas velhas
+            // manteriam o MotionGate acordado para sempre
+            boxTracker.reset();
+        }
+        
+        // Cena parada e nenhuma trilha ativa: nem detector nem rastreio
+        bool trackActive = objectTracker.hasTracks() || boxTracker.isActive();
+        if (motionGateEnabled && !motionGate.shouldDetect(packet.frame, trackActive, packet.captureTime)) {
+            packet.detections.clear();
+            keyframe = false;
+            gatedFrames++;
+        } else if (motionGateEnabled && !trackActive) {
+            keyframe = true; // Movimento numa cena vazia: detecta já
+        } else if (!keyframe) {
+            // Entre keyframes as caixas vêm do rastreador; se ele degradar
+            // (pontos perdidos, erro ida e volta alto), força uma nova
+            // detecção neste mesmo frame. A confiança do YOLO não entra:
+            // caixas recuperadas abaixo do limiar são esperadas aqui
+            keyframe = !boxTracker.update(packet.frame, packet.detections);
+        }
+        
+        if (keyframe) {
+            updateInputHint(packet.frame.size());
+            packet.detections = detectWithRoi(packet.frame);
+            framesSinceKeyframe = 0;
         } else {
-            ptz_speed_y_target = std::max(1.0f, ptz_speed_y_target * 0.7f);
+            framesSinceKeyframe++;
+        }
+        // Abaixo do limiar só passam caixas que recuperam uma trilha ativa
+        objectTracker.high_thresh = std::max(confThreshold.load(), objectTracker.low_thresh);
+        packet.detections = objectTracker.update(packet.detections);
+        if (keyframe && interval > 1) {
+            boxTracker.init(packet.frame, packet.detections);
         }
+        inferLatency.record(elapsedUs(inferStart));
+        
+        controlQueue.push(packet);
+        renderQueue.push(std::move(packet));
     }
     
-    // Limitar aceleração (slew rate)
-    float max_delta = slew_rate * dt;
-    ptz_speed_x_target = std::clamp(ptz_speed_x_target, 
-                                     prev_ptz_speed_x - max_delta,
-                                     prev_ptz_speed_x + max_delta);
-    ptz_speed_y_target = std::clamp(ptz_speed_y_target,
-                                     prev_ptz_speed_y - max_delta,
-                                     prev_ptz_speed_y + max_delta);
-    
-    // LPF final
-    float alpha_lpf = std::exp(-dt / lpf_tau);
-    float ptz_speed_x = alpha_lpf * prev_ptz_speed_x + (1 - alpha_lpf) * ptz_speed_x_target;
-    float ptz_speed_y = alpha_lpf * prev_ptz_speed_y + (1 - alpha_lpf) * ptz_speed_y_target;
-    
-    // Clamping final
-    ptz_speed_x = std::clamp(ptz_speed_x, 1.0f, 2.0f);
-    ptz_speed_y = std::clamp(ptz_speed_y, 1.0f, 2.0f);
-    
-    // Converter para comandos PTZ com direção
-    int pan_cmd = static_cast<int>(ptz_speed_x * std::copysign(1.0f, err_x_eff) * 6.0f);
-    int tilt_cmd = static_cast<int>(-ptz_speed_y * std::copysign(1.0f, err_y_eff) * 5.0f);
+    if (inferenceService) inferenceService->unregisterClient();
+    controlQueue.close();
+    renderQueue.close();
+}
+
+void CaptureEngine::controlLoop() {
+    // Taxa fixa: o PID roda com dt constante, desacoplado da inferência.
+    // As detecções chegam como observações com o timestamp de captura.
+    FramePacket packet;
+    auto nextTick = std::chrono::steady_clock::now();
     
-    // Enviar comando apenas se significativo
-    if (std::abs(err_x_eff) > 0.01f || std::abs(err_y_eff) > 0.01f) {
-        emit ptzAdjustmentNeeded(pan_cmd, tilt_cmd);
-    } else if (!manual_mode) {
-        emit ptzAdjustmentNeeded(0, 0);
+    while (running) {
+        auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / controlRateHz));
+        float dt = 1.0f / controlRateHz;
+        
+        bool manualMode;
+        {
+            // O modo manual é alterado pela GUI: lido sob o mesmo lock
+            std::lock_guard<std::mutex> lock(controllerMutex);
+            auto recorder = activeRecorder();
+            while (controlQueue.tryPop(packet)) {
+                controller.observe(packet.frame.size(), packet.detections, toSeconds(packet.captureTime));
+                if (recorder) {
+                    recorder->recordObserve(toSeconds(packet.captureTime), packet.frame.size(), packet.detections);
+                }
+            }
+            manualMode = controller.isManualMode();
+        }
+        
+        // Controle PTZ avançado
+        if (autoTracking || manualMode) {
+            auto controlStart = std::chrono::steady_clock::now();
+            processPTZControl(toSeconds(controlStart), dt);
+            controlLatency.record(elapsedUs(controlStart));
+        }
+        
+        nextTick += period;
+        auto now = std::chrono::steady_clock::now();
+        if (nextTick < now) {
+            nextTick = now; // Atrasado: não acumula ticks perdidos
+        }
+        std::this_thread::sleep_until(nextTick);
     }
-    
-    // Atualizar estados
-    prev_err_x = err_x_eff;
-    prev_err_y = err_y_eff;
-    prev_ptz_speed_x = ptz_speed_x;
-    prev_ptz_speed_y = ptz_speed_y;
 }
 
-Detection CaptureEngine::selectBestTarget(const cv::Mat& frame, 
-                                          const std::vector<Detection>& detections) {
-    Detection best = detections[0];
-    float bestScore = 0;
-    
-    cv::Point2f frameCenter(frame.cols / 2.0f, frame.rows / 2.0f);
+void CaptureEngine::renderLoop() {
+    FramePacket packet;
+    auto lastFpsTime = std::chrono::steady_clock::now();
+    int frameCounter = 0;
     
-    for (const auto& det : detections) {
-        cv::Point2f center(det.bbox.x + det.bbox.width / 2.0f,
-                          det.bbox.y + det.bbox.height / 2.0f);
+    while (renderQueue.pop(packet)) {
+        auto renderStart = std::chrono::steady_clock::now();
+        // Caixas vão como dados: o VideoWidget desenha na resolução da tela
+        emit frameReady(matToQImage(packet.frame), buildOverlay(packet.detections));
+        emit detectionCount(packet.detections.size());
         
-        float area = det.bbox.width * det.bbox.height;
-        float distToCenter = std::sqrt(std::pow(center.x - frameCenter.x, 2) + 
-                                      std::pow(center.y - frameCenter.y, 2));
+        renderLatency.record(elapsedUs(renderStart));
+        endToEndLatency.record(elapsedUs(packet.captureTime));
         
-        float score = (area / (distToCenter + 100.0f)) * det.confidence;
+        frameCounter++;
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration<double>(now - lastFpsTime).count();
         
-        if (score > bestScore) {
-            bestScore = score;
-            best = det;
+        if (elapsed >= 1.0) {
+            double fps = frameCounter / elapsed;
+            emit fpsUpdated(fps);
+            emit telemetryUpdated(collectTelemetry(fps));
+            frameCounter = 0;
+            lastFpsTime = now;
         }
     }
-    
-    return best;
 }
 
-float CaptureEngine::applyDeadband(float err) {
-    if (std::abs(err) < deadband) {
-        return 0.0f;
+PipelineTelemetry CaptureEngine::collectTelemetry(double fps) {
+    PipelineTelemetry telemetry;
+    telemetry.capture = toStageLatency(captureLatency.takeSnapshot());
+    telemetry.queueWait = toStageLatency(queueLatency.takeSnapshot());
+    telemetry.inference = toStageLatency(inferLatency.takeSnapshot());
+    telemetry.control = toStageLatency(controlLatency.takeSnapshot());
+    telemetry.render = toStageLatency(renderLatency.takeSnapshot());
+    telemetry.endToEnd = toStageLatency(endToEndLatency.takeSnapshot());
+    telemetry.compensation = toStageLatency(compensationLatency.takeSnapshot());
+    telemetry.fps = fps;
+    telemetry.droppedInfer = inferQueue.droppedCount();
+    telemetry.droppedControl = controlQueue.droppedCount();
+    telemetry.droppedRender = renderQueue.droppedCount();
+    telemetry.inferQueueDepth = (int)inferQueue.size();
+    telemetry.controlQueueDepth = (int)controlQueue.size();
+    telemetry.renderQueueDepth = (int)renderQueue.size();
+    telemetry.gatedFrames = gatedFrames;
+    telemetry.inputSize = lastInputSize;
+    {
+        std::lock_guard<std::mutex> lock(ingestMutex);
+        telemetry.ingest = ingestInfo;
     }
-    return std::copysign(std::abs(err) - deadband, err);
+    return telemetry;
 }
 
-float CaptureEngine::applyNonLinearity(float raw_speed) {
-    float abs_speed = std::abs(raw_speed);
-    float a = 1.5f; // Fator de normalização
-    float speed_factor = a * std::pow(abs_speed, gamma);
-    return std::clamp(speed_factor, 0.0f, 1.0f);
+void CaptureEngine::processPTZControl(double now, float dt) {
+    PTZCommand cmd;
+    bool valid;
+    float nx, ny, nz;
+    int lockedId;
+    {
+        std::lock_guard<std::mutex> lock(controllerMutex);
+        // Zoom em curso desde o último passo: mesma curva de motor da
+        // VirtualPTZCamera (lenta embaixo, rápida no topo)
+        int zoomSpeed = lastZoomSpeed;
+        if (zoomSpeed != 0) {
+            double rate = zoom_rate_max * std::pow(std::min(std::abs(zoomSpeed), 7) / 7.0, 1.6);
+            zoomEstimate *= std::exp((zoomSpeed > 0 ? rate : -rate) * dt);
+            zoomEstimate = std::clamp(zoomEstimate, 1.0, (double)zoom_max);
+        }
+        controller.zoom_factor = (float)zoomEstimate;
+        
+        bool tracking = autoTracking;
+        cmd = controller.step(now, dt, tracking);
+        if (auto recorder = activeRecorder()) {
+            // Entradas e estado completos: o replay refaz este passo sozinho
+            Session::StepRecord record;
+            record.dt = dt;
+            record.autoTracking = tracking;
+            record.latencyCompensation = controller.latency_compensation;
+            record.autoZoom = controller.auto_zoom;
+            record.actuationDelay = controller.actuation_delay;
+            record.zoomFactor = controller.zoom_factor;
+            record.command = cmd;
+            record.state = controller.state();
+            recorder->recordStep(now, record);
+        }
+        valid = controller.targetHint(nx, ny, nz);
+        lockedId = controller.lockedTrackId();
+        if (valid && !controller.isManualMode()) {
+            compensationLatency.record((uint64_t)(controller.compensatedDelay() * 1e6));
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(targetHintMutex);
+        hint_valid = valid;
+        hint_locked_id = lockedId;
+        hint_nx = nx;
+        hint_ny = ny;
+        hint_nz = nz;
+    }
+    
+    if (cmd.send) {
+        emit ptzAdjustmentNeeded(cmd.pan, cmd.tilt);
+    }
+    if (lastZoomSpeed.exchange(cmd.zoom) != cmd.zoom) {
+        emit zoomAdjustmentNeeded(cmd.zoom);
+    }
 }
 
-void CaptureEngine::drawDetections(cv::Mat& frame, const std::vector<Detection>& dets) {
+FrameOverlay CaptureEngine::buildOverlay(const std::vector<Detection>& dets) {
+    int lockedId;
+    {
+        std::lock_guard<std::mutex> lock(targetHintMutex);
+        lockedId = hint_locked_id;
+    }
+    
+    FrameOverlay overlay;
+    overlay.boxes.reserve((int)dets.size());
     for (const auto& det : dets) {
-        cv::rectangle(frame, det.bbox, cv::Scalar(0, 255, 0), 2);
-        
-        std::string label = det.label + " " + 
-                           std::to_string((int)(det.confidence * 100)) + "%";
-        
-        int baseline;
-        cv::Size textSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 
-                                            0.6, 2, &baseline);
-        
-        cv::rectangle(frame, 
-            cv::Point(det.bbox.x, det.bbox.y - textSize.height - 5),
-            cv::Point(det.bbox.x + textSize.width, det.bbox.y),
-            cv::Scalar(0, 255, 0), -1);
-        
-        cv::putText(frame, label, 
-            cv::Point(det.bbox.x, det.bbox.y - 5),
-            cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 0, 0), 2);
-        
-        int cx = det.bbox.x + det.bbox.width / 2;
-        int cy = det.bbox.y + det.bbox.height / 2;
-        cv::circle(frame, cv::Point(cx, cy), 5, cv::Scalar(0, 255, 255), -1);
+        OverlayBox box;
+        box.rect = QRect(det.bbox.x, det.bbox.y, det.bbox.width, det.bbox.height);
+        box.locked = det.trackId >= 0 && det.trackId == lockedId;
+        box.label = QString("%1 %2%").arg(QString::fromStdString(det.label)).arg((int)(det.confidence * 100));
+        if (det.trackId >= 0) {
+            box.label = QString("#%1 ").arg(det.trackId) + box.label;
+        }
+        overlay.boxes.append(box);
     }
+    return overlay;
 }
 
 QImage CaptureEngine::matToQImage(const cv::Mat& mat) {
-    cv::Mat rgb;
-    cv::cvtColor(mat, rgb, cv::COLOR_BGR2RGB);
-    return QImage(rgb.data, rgb.cols, rgb.rows, rgb.step, 
-                  QImage::Format_RGB888).copy();
+    return framePool->wrap(mat);
 }
\ No newline at end of file
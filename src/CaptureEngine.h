@@ -4,16 +4,82 @@
 #include <QObject>
 #include <QThread>
 #include <QImage>
+#include <QMetaType>
 #include <opencv2/opencv.hpp>
 #include <atomic>
 #include <memory>
+#include <chrono>
+#include <mutex>
 #include "YOLODetector.h"
+#include "InferenceService.h"
+#include "BoxTracker.h"
+#include "MultiObjectTracker.h"
+#include "TrackingController.h"
+#include "LatestQueue.h"
+#include "FramePool.h"
+#include "LatencyHistogram.h"
+#include "VirtualPTZCamera.h"
+#include "FrameDecoder.h"
+#include "MotionGate.h"
+#include "SessionRecorder.h"
+#include "FrameOverlay.h"
+
+// Frame em trânsito entre os estágios do pipeline
+struct FramePacket {
+    cv::Mat frame;
+    std::vector<Detection> detections;
+    uint64_t sequence = 0;
+    std::chrono::steady_clock::time_point captureTime;
+};
+
+// Formato pedido à câmera e resolução em que o pipeline trabalha
+struct CaptureConfig {
+    cv::Size resolution{640, 480};     // pedida ao driver
+    std::string pixelFormat = "auto";  // auto | mjpeg | yuyv | nv12 | bgr
+    int processWidth = 640;            // largura mínima após a redução (0 = cheia)
+};
+
+// Latência de um estágio na última janela de telemetria
+struct StageLatency {
+    int count = 0;
+    double p50Ms = 0;
+    double p95Ms = 0;
+    double p99Ms = 0;
+    double maxMs = 0;
+};
+
+// Telemetria do pipeline, emitida uma vez por segundo
+struct PipelineTelemetry {
+    StageLatency capture;   // retrieve/decodificação do frame
+    StageLatency queueWait; // captura -> início da inferência
+    StageLatency inference;
+    StageLatency control;
+    StageLatency render;    // desenho + conversão + emissão
+    StageLatency endToEnd;  // captura -> frame entregue à GUI
+    StageLatency compensation; // atraso compensado pelo controle (captura -> motor)
+    double fps = 0;
+    // Frames sobrescritos nas filas latest-wins (acumulado)
+    quint64 droppedInfer = 0;
+    quint64 droppedControl = 0;
+    quint64 droppedRender = 0;
+    int inferQueueDepth = 0;
+    int controlQueueDepth = 0;
+    int renderQueueDepth = 0;
+    quint64 gatedFrames = 0; // frames sem inferência pelo MotionGate (acumulado)
+    int inputSize = 0; // entrada da rede no último frame detectado
+    QString ingest;    // formato negociado e redução na decodificação
+};
+Q_DECLARE_METATYPE(PipelineTelemetry)
 
 class CaptureEngine : public QObject {
     Q_OBJECT
 
 public:
-    CaptureEngine(const std::string& source, int fps, float threshold);
+    // Com inferenceService a engine não carrega detector próprio: os frames
+    // vão para o lote compartilhado com as outras câmeras do host
+    CaptureEngine(const std::string& source, int fps, float threshold,
+                  const BackendConfig& backendConfig = BackendConfig(),
+                  std::shared_ptr<InferenceService> inferenceService = nullptr);
     ~CaptureEngine();
     
     void start();
@@ -21,51 +87,133 @@ public:
     void setConfidenceThreshold(float threshold);
     void setAutoTracking(bool enabled);
     void setManualTarget(float x, float y);
+    // Roda o YOLO só a cada N frames; entre eles as caixas são rastreadas
+    void setKeyframeInterval(int frames);
+    // Pula o detector em cena parada sem trilha ativa (com keep-alive)
+    void setMotionGate(bool enabled);
+    // Formato/resolução da câmera; vale no próximo start()
+    void setCaptureConfig(const CaptureConfig& config);
+    // Inferência num recorte em torno da posição prevista do alvo
+    void setRoiMode(bool enabled);
+    // Frequência do laço de controle PTZ (independente da inferência)
+    void setControlRate(int hz);
+    // Orçamento de preprocess + forward: a entrada da rede varia entre
+    // 256 e 640 conforme o custo medido e o tamanho do alvo (0 = fixa)
+    void setInferenceBudget(double ms);
+    // Zoom automático pelo tamanho do alvo (junto com o Auto PTZ)
+    void setAutoZoom(bool enabled);
+    // Grava frames, detecções e passos do controle (nullptr para parar).
+    // Anexar uma gravação zera o controle: o replay começa do mesmo estado
+    void setRecorder(std::shared_ptr<SessionRecorder> recorder);
+
+public slots:
+    // Atraso de atuação medido (RTT do ACK VISCA); suavizado internamente
+    void setActuationDelay(double ms);
 
 signals:
-    void frameReady(const QImage& frame);
+    void frameReady(const QImage& frame, const FrameOverlay& overlay);
     void fpsUpdated(double fps);
+    void telemetryUpdated(const PipelineTelemetry& telemetry);
     void detectionCount(int count);
     void ptzAdjustmentNeeded(int pan, int tilt);
+    void zoomAdjustmentNeeded(int speed);
 
 private:
-    void captureLoop();
-    void processPTZControl(const cv::Mat& frame, const std::vector<Detection>& detections, float dt);
-    Detection selectBestTarget(const cv::Mat& frame, const std::vector<Detection>& detections);
-    float applyDeadband(float err);
-    float applyNonLinearity(float raw_speed);
-    void resetPIDState();
+    // Estágios do pipeline (cada um em sua thread)
+    void grabLoop();
+    void simGrabLoop();
+    void inferLoop();
+    void controlLoop();
+    void renderLoop();
+    
+    std::vector<Detection> runDetector(const cv::Mat& frame);
+    std::vector<Detection> detectWithRoi(const cv::Mat& frame);
+    bool computeRoi(const cv::Size& frameSize, cv::Rect& roi);
+    void updateInputHint(const cv::Size& frameSize);
+    void processPTZControl(double now, float dt);
+    PipelineTelemetry collectTelemetry(double fps);
+    std::shared_ptr<SessionRecorder> activeRecorder();
     QImage matToQImage(const cv::Mat& mat);
-    void drawDetections(cv::Mat& frame, const std::vector<Detection>& dets);
+    FrameOverlay buildOverlay(const std::vector<Detection>& dets);
     
     std::string videoSource;
+    CaptureConfig captureConfig;
+    std::mutex ingestMutex;
+    QString ingestInfo;
+    std::shared_ptr<VirtualPTZCamera> simCamera; // fonte "sim:<arquivo>"
     int targetFPS;
-    float confThreshold;
+    // Limiar do usuário: aplicado pelo objectTracker depois da associação
+    std::atomic<float> confThreshold;
     std::atomic<bool> running;
     std::atomic<bool> autoTracking;
-    QThread* captureThread;
+    QThread* grabThread;
+    QThread* inferThread;
+    QThread* controlThread;
+    QThread* renderThread;
     std::unique_ptr<YOLODetector> detector;
+    // Fixado no construtor: as threads só leem
+    const std::shared_ptr<InferenceService> inferenceService;
+    
+    // Keyframes + rastreio leve (usado apenas pela thread de inferência)
+    std::atomic<int> keyframeInterval;
+    BoxTracker boxTracker;
+    // IDs persistentes das pessoas (thread de inferência)
+    MultiObjectTracker objectTracker;
+    // Detector de mudança na frente do YOLO (thread de inferência)
+    std::atomic<bool> motionGateEnabled;
+    MotionGate motionGate;
+    std::atomic<quint64> gatedFrames;
+    
+    // ROI: última posição do alvo publicada pelo controle para a inferência
+    std::atomic<bool> roiMode;
+    std::mutex targetHintMutex;
+    bool hint_valid;
+    float hint_nx, hint_ny, hint_nz;
+    int hint_locked_id; // trilha seguida, destacada no render
+    int framesSinceFullScan;
+    
+    // Entrada adaptativa do detector
+    std::atomic<double> inferBudgetMs;
+    std::atomic<int> lastInputSize;
+    float inputHintPx; // vai junto com cada pedido ao inferenceService
+    
+    // Filas latest-wins entre estágios
+    LatestQueue<FramePacket> inferQueue;
+    LatestQueue<FramePacket> controlQueue;
+    LatestQueue<FramePacket> renderQueue;
+    
+    // Histogramas por estágio (escritos pelas threads do pipeline)
+    LatencyHistogram captureLatency;
+    LatencyHistogram queueLatency;
+    LatencyHistogram inferLatency;
+    LatencyHistogram controlLatency;
+    LatencyHistogram renderLatency;
+    LatencyHistogram endToEndLatency;
+    LatencyHistogram compensationLatency;
+    
+    // Buffers compartilhados com a GUI (sem cópias até o VideoWidget)
+    std::shared_ptr<FramePool> framePool;
+    
+    // Seleção de alvo + PID (protegido: a GUI também altera o estado)
+    std::mutex controllerMutex;
+    TrackingController controller;
+    std::atomic<int> controlRateHz;
+    double actuationDelayMs; // média móvel (protegida por controllerMutex)
+    double zoomEstimate;     // zoom integrado dos comandos (protegido por controllerMutex)
+    std::atomic<int> lastZoomSpeed; // último zoom emitido (evita repetir o sinal)
     
-    // PID control state
-    float integral_x, integral_y;
-    float prev_err_x, prev_err_y;
-    float filtered_derivative_x, filtered_derivative_y;
-    float prev_ptz_speed_x, prev_ptz_speed_y;
-    float last_nx, last_ny, last_nz;
-    int lost_frames;
+    // Gravação de sessão (trocada pela GUI com o pipeline rodando)
+    std::mutex recorderMutex;
+    std::shared_ptr<SessionRecorder> sessionRecorder;
     
-    // Manual mode
-    bool manual_mode;
-    float manual_target_x, manual_target_y;
+    // ROI
+    float roi_margin;
+    int roi_full_scan_interval;
     
-    // Control parameters
-    float conf_min, nz_min, deadband;
-    float Kp_x, Ki_x, Kd_x;
-    float Kp_y, Ki_y, Kd_y;
-    float I_max, gamma;
-    float near_edge_threshold, approach_limit, v_thresh;
-    float slew_rate, lpf_tau, stop_threshold;
-    int lost_max_frames;
+    // Estimativa do zoom para a compensação de latência: integra os comandos
+    // do zoom automático (o zoom pelo painel manual não entra)
+    float zoom_rate_max; // log-zoom/s na velocidade VISCA 7
+    float zoom_max;      // zoom óptico máximo da câmera
 };
 
 #endif
\ No newline at end of file
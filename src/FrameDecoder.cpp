@@ -0,0 +1,153 @@
+#include "FrameDecoder.h"
+#include <algorithm>
+
+namespace {
+
+// YCbCr BT.601 (faixa limitada) -> BGR em ponto fixo
+inline void yuvToBgr(int y, int u, int v, uchar* dst) {
+    int c = 298 * (y - 16) + 128;
+    int d = u - 128;
+    int e = v - 128;
+    dst[0] = cv::saturate_cast<uchar>((c + 516 * d) >> 8);
+    dst[1] = cv::saturate_cast<uchar>((c - 100 * d - 208 * e) >> 8);
+    dst[2] = cv::saturate_cast<uchar>((c + 409 * e) >> 8);
+}
+
+// YUYV (Y0 U Y1 V por par de pixels) -> BGR em meia resolução: cada pixel
+// de saída é a média de um bloco 2x2 de luma com o croma das duas linhas
+void yuyvToBgrHalf(const cv::Mat& yuyv, cv::Mat& bgr) {
+    bgr.create(yuyv.rows / 2, yuyv.cols / 2, CV_8UC3);
+    cv::parallel_for_(cv::Range(0, bgr.rows), [&](const cv::Range& range) {
+        for (int oy = range.start; oy < range.end; oy++) {
+            const uchar* r0 = yuyv.ptr<uchar>(2 * oy);
+            const uchar* r1 = yuyv.ptr<uchar>(2 * oy + 1);
+            uchar* dst = bgr.ptr<uchar>(oy);
+            for (int ox = 0; ox < bgr.cols; ox++) {
+                const uchar* a = r0 + 4 * ox;
+                const uchar* b = r1 + 4 * ox;
+                int y = (a[0] + a[2] + b[0] + b[2] + 2) >> 2;
+                int u = (a[1] + b[1] + 1) >> 1;
+                int v = (a[3] + b[3] + 1) >> 1;
+                yuvToBgr(y, u, v, dst + 3 * ox);
+            }
+        }
+    });
+}
+
+// NV12 (plano Y + plano UV intercalado em meia resolução) -> BGR em meia
+// resolução: o croma já está na grade de saída, só a luma é média 2x2
+void nv12ToBgrHalf(const cv::Mat& nv12, int width, int height, cv::Mat& bgr) {
+    bgr.create(height / 2, width / 2, CV_8UC3);
+    cv::parallel_for_(cv::Range(0, bgr.rows), [&](const cv::Range& range) {
+        for (int oy = range.start; oy < range.end; oy++) {
+            const uchar* r0 = nv12.ptr<uchar>(2 * oy);
+            const uchar* r1 = nv12.ptr<uchar>(2 * oy + 1);
+            const uchar* uv = nv12.ptr<uchar>(height + oy);
+            uchar* dst = bgr.ptr<uchar>(oy);
+            for (int ox = 0; ox < bgr.cols; ox++) {
+                int y = (r0[2 * ox] + r0[2 * ox + 1] + r1[2 * ox] + r1[2 * ox + 1] + 2) >> 2;
+                yuvToBgr(y, uv[2 * ox], uv[2 * ox + 1], dst + 3 * ox);
+            }
+        }
+    });
+}
+
+// Buffer bruto (1xN bytes ou já HxW) visto como imagem rows x cols x type
+bool viewAs(const cv::Mat& raw, int rows, int cols, int type, cv::Mat& view) {
+    size_t bytes = (size_t)rows * cols * CV_ELEM_SIZE(type);
+    if (!raw.isContinuous() || raw.total() * raw.elemSize() < bytes) return false;
+    view = cv::Mat(rows, cols, type, (void*)raw.data);
+    return true;
+}
+
+}
+
+FrameDecoder::Format FrameDecoder::fromFourcc(int fourcc) {
+    if (fourcc == cv::VideoWriter::fourcc('M', 'J', 'P', 'G')) return Format::MJPEG;
+    if (fourcc == cv::VideoWriter::fourcc('Y', 'U', 'Y', 'V') ||
+        fourcc == cv::VideoWriter::fourcc('Y', 'U', 'Y', '2')) return Format::YUYV;
+    if (fourcc == cv::VideoWriter::fourcc('N', 'V', '1', '2')) return Format::NV12;
+    return Format::BGR;
+}
+
+int FrameDecoder::toFourcc(Format format) {
+    switch (format) {
+    case Format::MJPEG: return cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+    case Format::YUYV: return cv::VideoWriter::fourcc('Y', 'U', 'Y', 'V');
+    case Format::NV12: return cv::VideoWriter::fourcc('N', 'V', '1', '2');
+    default: return 0;
+    }
+}
+
+FrameDecoder::Format FrameDecoder::fromName(const std::string& name, const cv::Size& resolution,
+                                            int processWidth) {
+    if (name == "mjpeg") return Format::MJPEG;
+    if (name == "yuyv") return Format::YUYV;
+    if (name == "nv12") return Format::NV12;
+    if (name == "bgr") return Format::BGR;
+    // auto: acima de 2x a largura de processamento a IDCT reduzida compensa
+    // (e o YUYV nem cabe no USB 2.0 a 30 FPS)
+    return processWidth > 0 && resolution.width >= 2 * processWidth ? Format::MJPEG : Format::YUYV;
+}
+
+const char* FrameDecoder::name(Format format) {
+    switch (format) {
+    case Format::MJPEG: return "mjpeg";
+    case Format::YUYV: return "yuyv";
+    case Format::NV12: return "nv12";
+    default: return "bgr";
+    }
+}
+
+void FrameDecoder::configure(Format format, const cv::Size& sourceSize, int processWidth) {
+    fmt = format;
+    source = sourceSize;
+    denominator = 1;
+
+    // Maior redução que ainda mantém processWidth: JPEG reduz até 1/8 na
+    // IDCT; YUV só tem o caminho fundido 1/2
+    int maxDenominator = format == Format::MJPEG ? 8 : (format == Format::BGR ? 1 : 2);
+    while (processWidth > 0 && denominator < maxDenominator &&
+           source.width / (denominator * 2) >= processWidth) {
+        denominator *= 2;
+    }
+}
+
+bool FrameDecoder::decode(const cv::Mat& raw, cv::Mat& out) const {
+    if (raw.empty()) return false;
+
+    // Backend que ignorou CONVERT_RGB (fora do V4L2): já vem em BGR
+    if (raw.type() == CV_8UC3) {
+        out = raw;
+        return true;
+    }
+
+    cv::Mat view;
+    switch (fmt) {
+    case Format::MJPEG: {
+        static const int flags[] = {cv::IMREAD_COLOR, cv::IMREAD_REDUCED_COLOR_2,
+                                    cv::IMREAD_REDUCED_COLOR_4, cv::IMREAD_REDUCED_COLOR_8};
+        int index = denominator == 8 ? 3 : denominator / 2;
+        out = cv::imdecode(raw, flags[index]);
+        return !out.empty();
+    }
+    case Format::YUYV:
+        if (!viewAs(raw, source.height, source.width, CV_8UC2, view)) return false;
+        if (denominator == 2) {
+            yuyvToBgrHalf(view, out);
+        } else {
+            cv::cvtColor(view, out, cv::COLOR_YUV2BGR_YUYV);
+        }
+        return true;
+    case Format::NV12:
+        if (!viewAs(raw, source.height * 3 / 2, source.width, CV_8UC1, view)) return false;
+        if (denominator == 2) {
+            nv12ToBgrHalf(view, source.width, source.height, out);
+        } else {
+            cv::cvtColor(view, out, cv::COLOR_YUV2BGR_NV12);
+        }
+        return true;
+    default:
+        return false;
+    }
+}
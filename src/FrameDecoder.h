@@ -0,0 +1,36 @@
+#ifndef FRAMEDECODER_H
+#define FRAMEDECODER_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+// Decodifica o buffer bruto da câmera (CAP_PROP_CONVERT_RGB desligado) já
+// na resolução de processamento: JPEG com redução na própria IDCT
+// (libjpeg-turbo, 1/2..1/8) e YUYV/NV12 com conversão de cor e redução 2x
+// numa única passada. Evita decodificar 1080p inteiro para depois reduzir.
+class FrameDecoder {
+public:
+    enum class Format { BGR, MJPEG, YUYV, NV12 };
+
+    static Format fromFourcc(int fourcc);
+    static int toFourcc(Format format);
+    // "auto" escolhe MJPEG quando a redução compensa, senão YUYV
+    static Format fromName(const std::string& name, const cv::Size& resolution, int processWidth);
+    static const char* name(Format format);
+
+    // sourceSize: resolução negociada com o driver; processWidth: largura
+    // mínima desejada após a redução (0 = resolução cheia)
+    void configure(Format format, const cv::Size& sourceSize, int processWidth);
+    // false quando o buffer não corresponde ao formato configurado
+    bool decode(const cv::Mat& raw, cv::Mat& out) const;
+
+    Format format() const { return fmt; }
+    int scale() const { return denominator; }
+
+private:
+    Format fmt = Format::BGR;
+    cv::Size source;
+    int denominator = 1;
+};
+
+#endif
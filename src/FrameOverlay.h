@@ -0,0 +1,23 @@
+#ifndef FRAMEOVERLAY_H
+#define FRAMEOVERLAY_H
+
+#include <QMetaType>
+#include <QRect>
+#include <QString>
+#include <QVector>
+
+// Detecção já formatada para o VideoWidget, em coordenadas do frame
+struct OverlayBox {
+    QRect rect;
+    QString label; // "#3 Person 87%"
+    bool locked = false; // alvo seguido pelo controle
+};
+
+// Sobreposições de um frame: viajam junto com o QImage e são desenhadas
+// com QPainter na resolução da tela, sem tocar nos pixels do frame
+struct FrameOverlay {
+    QVector<OverlayBox> boxes;
+};
+Q_DECLARE_METATYPE(FrameOverlay)
+
+#endif
@@ -0,0 +1,65 @@
+#include "FramePool.h"
+
+std::shared_ptr<FramePool> FramePool::create(int capacity) {
+    return std::shared_ptr<FramePool>(new FramePool(capacity));
+}
+
+FramePool::FramePool(int capacity) : capacity(capacity) {
+    for (int i = 0; i < capacity; i++) {
+        buffers.push_back(std::make_unique<Buffer>());
+        freeList.push_back(buffers.back().get());
+    }
+}
+
+int FramePool::available() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (int)freeList.size();
+}
+
+FramePool::Buffer* FramePool::acquire(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    Buffer* buffer;
+    if (freeList.empty()) {
+        // GUI segurando mais frames que o previsto: cresce o pool
+        buffers.push_back(std::make_unique<Buffer>());
+        buffer = buffers.back().get();
+    } else {
+        buffer = freeList.back();
+        freeList.pop_back();
+    }
+    
+    // Só realoca quando a resolução muda
+    if (buffer->data.size() != bytes) {
+        buffer->data.resize(bytes);
+    }
+    buffer->owner = shared_from_this();
+    return buffer;
+}
+
+void FramePool::release(Buffer* buffer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeList.push_back(buffer);
+}
+
+void FramePool::releaseCallback(void* info) {
+    Buffer* buffer = static_cast<Buffer*>(info);
+    std::shared_ptr<FramePool> pool = std::move(buffer->owner);
+    pool->release(buffer);
+}
+
+QImage FramePool::wrap(const cv::Mat& bgr) {
+    if (bgr.empty() || bgr.type() != CV_8UC3) {
+        return QImage();
+    }
+    
+    // Linhas alinhadas em 4 bytes, como o QImage prefere
+    size_t stride = ((size_t)bgr.cols * 3 + 3) & ~(size_t)3;
+    Buffer* buffer = acquire(stride * bgr.rows);
+    
+    cv::Mat rgb(bgr.rows, bgr.cols, CV_8UC3, buffer->data.data(), stride);
+    cv::cvtColor(bgr, rgb, cv::COLOR_BGR2RGB);
+    
+    return QImage(buffer->data.data(), bgr.cols, bgr.rows, (qsizetype)stride,
+                  QImage::Format_RGB888, &FramePool::releaseCallback, buffer);
+}
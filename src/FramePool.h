@@ -0,0 +1,40 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <QImage>
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Pool de buffers pré-alocados compartilhado entre a thread de captura e a GUI.
+// O QImage retornado por wrap() aponta direto para a memória do pool e devolve
+// o buffer quando a última cópia implícita do QImage é destruída.
+class FramePool : public std::enable_shared_from_this<FramePool> {
+public:
+    static std::shared_ptr<FramePool> create(int capacity);
+    
+    // Converte BGR -> RGB uma única vez, dentro de um buffer do pool
+    QImage wrap(const cv::Mat& bgr);
+    
+    int available() const;
+
+private:
+    struct Buffer {
+        std::vector<uchar> data;
+        std::shared_ptr<FramePool> owner; // Mantém o pool vivo enquanto emprestado
+    };
+    
+    explicit FramePool(int capacity);
+    
+    Buffer* acquire(size_t bytes);
+    void release(Buffer* buffer);
+    static void releaseCallback(void* info);
+    
+    int capacity;
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    std::vector<Buffer*> freeList;
+};
+
+#endif
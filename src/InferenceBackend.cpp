@@ -0,0 +1,38 @@
+#include "InferenceBackend.h"
+#include "OpenCVBackend.h"
+#ifdef PTZ_WITH_ONNXRUNTIME
+#include "OnnxRuntimeBackend.h"
+#endif
+#ifdef PTZ_WITH_OPENVINO
+#include "OpenVINOBackend.h"
+#endif
+#include <stdexcept>
+
+std::unique_ptr<InferenceBackend> InferenceBackend::create(const std::string& modelPath,
+                                                           const BackendConfig& config) {
+    if (config.type == "opencv") {
+        return std::make_unique<OpenCVBackend>(modelPath, config);
+    }
+#ifdef PTZ_WITH_ONNXRUNTIME
+    if (config.type == "onnxruntime") {
+        return std::make_unique<OnnxRuntimeBackend>(modelPath, config);
+    }
+#endif
+#ifdef PTZ_WITH_OPENVINO
+    if (config.type == "openvino") {
+        return std::make_unique<OpenVINOBackend>(modelPath, config);
+    }
+#endif
+    throw std::runtime_error("Backend de inferência indisponível: " + config.type);
+}
+
+std::vector<std::string> InferenceBackend::available() {
+    std::vector<std::string> names = {"opencv"};
+#ifdef PTZ_WITH_ONNXRUNTIME
+    names.push_back("onnxruntime");
+#endif
+#ifdef PTZ_WITH_OPENVINO
+    names.push_back("openvino");
+#endif
+    return names;
+}
@@ -0,0 +1,32 @@
+#ifndef INFERENCEBACKEND_H
+#define INFERENCEBACKEND_H
+
+#include <opencv2/core.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Configuração do motor de inferência, escolhida em tempo de execução
+struct BackendConfig {
+    std::string type = "opencv";  // opencv | onnxruntime | openvino
+    int threads = 0;              // 0 = padrão do runtime
+    bool optimizeGraph = true;    // Fusão/otimização do grafo
+};
+
+// Motor de inferência por trás do YOLODetector.
+// Recebe o tensor NCHW float e devolve as saídas como cv::Mat; as saídas
+// só precisam ser válidas até a próxima chamada de forward().
+class InferenceBackend {
+public:
+    virtual ~InferenceBackend() = default;
+    
+    virtual void forward(const cv::Mat& input, std::vector<cv::Mat>& outputs) = 0;
+    virtual std::string name() const = 0;
+    
+    // Lança std::runtime_error para tipos não compilados neste build
+    static std::unique_ptr<InferenceBackend> create(const std::string& modelPath,
+                                                    const BackendConfig& config);
+    static std::vector<std::string> available();
+};
+
+#endif
@@ -0,0 +1,167 @@
+#include "InferenceService.h"
+#include <algorithm>
+#include <map>
+#include <string>
+
+InferenceService::InferenceService(const std::string& modelPath, float confThreshold,
+                                   int maxBatch, int windowMs,
+                                   const BackendConfig& backendConfig)
+    : maxBatch(std::max(1, maxBatch)), window(windowMs),
+      activeSide(0), largestSide(0), adaptive(false),
+      clients(0), stopping(false)
+{
+    detector = std::make_unique<YOLODetector>(modelPath, confThreshold, backendConfig);
+    activeSide = detector->inputSize().width;
+    largestSide = activeSide.load();
+    worker = std::thread([this]() { run(); });
+}
+
+InferenceService::~InferenceService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cond.notify_all();
+    worker.join();
+}
+
+std::shared_ptr<InferenceService> InferenceService::shared(const std::string& modelPath,
+                                                           const BackendConfig& backendConfig) {
+    static std::mutex registryMutex;
+    static std::map<std::string, std::weak_ptr<InferenceService>> registry;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::string key = modelPath + "|" + backendConfig.type + "|" + std::to_string(backendConfig.threads) +
+                      (backendConfig.optimizeGraph ? "|opt" : "");
+    auto service = registry[key].lock();
+    if (!service) {
+        service = std::make_shared<InferenceService>(modelPath, 0.5f, 4, 5, backendConfig);
+        registry[key] = service;
+    }
+    return service;
+}
+
+std::future<InferenceService::Result> InferenceService::submit(const cv::Mat& frame,
+                                                               float targetHintPx, double budgetMs) {
+    Request request;
+    request.frame = frame;
+    request.targetHintPx = targetHintPx;
+    request.budgetMs = budgetMs;
+    auto future = request.result.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            request.result.set_value(Result());
+            return future;
+        }
+        pending.push_back(std::move(request));
+    }
+    cond.notify_all();
+    return future;
+}
+
+cv::Size InferenceService::upcomingInputSize(double budgetMs) const {
+    // Com orçamento (deste pedido ou de outra câmera) o lote pode subir até
+    // a maior entrada; sem orçamento fica na atual
+    int side = budgetMs > 0 || adaptive ? largestSide.load() : activeSide.load();
+    return cv::Size(side, side);
+}
+
+void InferenceService::setConfidenceThreshold(float threshold) {
+    std::lock_guard<std::mutex> lock(detectorMutex);
+    detector->setConfidenceThreshold(threshold);
+}
+
+void InferenceService::setInputSizes(const std::vector<int>& sizes) {
+    std::lock_guard<std::mutex> lock(detectorMutex);
+    detector->setInputSizes(sizes);
+    std::vector<int> all = detector->inputSizes();
+    largestSide = *std::max_element(all.begin(), all.end());
+    activeSide = detector->inputSize().width;
+}
+
+void InferenceService::setLetterbox(bool enabled) {
+    std::lock_guard<std::mutex> lock(detectorMutex);
+    detector->setLetterbox(enabled);
+}
+
+std::string InferenceService::backendName() const {
+    std::lock_guard<std::mutex> lock(detectorMutex);
+    return detector->backendName();
+}
+
+void InferenceService::registerClient() {
+    std::lock_guard<std::mutex> lock(mutex);
+    clients++;
+}
+
+void InferenceService::unregisterClient() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        clients = std::max(0, clients - 1);
+    }
+    cond.notify_all();
+}
+
+void InferenceService::run() {
+    std::vector<Request> batch;
+    std::vector<cv::Mat> frames;
+    std::vector<float> hints;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [this]() { return stopping || !pending.empty(); });
+            if (stopping && pending.empty()) break;
+
+            // Espera mais frames até completar o lote ou estourar a janela
+            auto deadline = std::chrono::steady_clock::now() + window;
+            cond.wait_until(lock, deadline, [this]() {
+                return stopping || (int)pending.size() >= std::min(maxBatch, std::max(1, clients));
+            });
+
+            size_t count = std::min(pending.size(), (size_t)maxBatch);
+            for (size_t i = 0; i < count; i++) {
+                batch.push_back(std::move(pending.front()));
+                pending.pop_front();
+            }
+        }
+
+        frames.clear();
+        hints.clear();
+        double budget = 0; // o menor orçamento pedido vale para o lote
+        for (auto& request : batch) {
+            frames.push_back(request.frame);
+            hints.push_back(request.targetHintPx);
+            if (request.budgetMs > 0 && (budget <= 0 || request.budgetMs < budget)) {
+                budget = request.budgetMs;
+            }
+        }
+
+        try {
+            std::vector<std::vector<Detection>> results;
+            int inputSize;
+            {
+                std::lock_guard<std::mutex> lock(detectorMutex);
+                detector->setLatencyBudget(budget);
+                results = detector->detectBatch(frames, hints);
+                inputSize = detector->lastTimings().inputSize;
+                activeSide = detector->inputSize().width;
+            }
+            adaptive = budget > 0;
+            for (size_t i = 0; i < batch.size(); i++) {
+                Result result;
+                result.detections = std::move(results[i]);
+                result.inputSize = inputSize;
+                result.batchSize = (int)batch.size();
+                batch[i].result.set_value(std::move(result));
+            }
+        } catch (...) {
+            for (auto& request : batch) {
+                request.result.set_exception(std::current_exception());
+            }
+        }
+        batch.clear();
+    }
+}
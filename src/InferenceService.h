@@ -0,0 +1,77 @@
+#ifndef INFERENCESERVICE_H
+#define INFERENCESERVICE_H
+
+#include "YOLODetector.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Serviço de inferência compartilhado entre várias CaptureEngine.
+// Junta os frames que chegam dentro de uma pequena janela de tempo e roda
+// um único forward em lote, devolvendo as detecções para cada solicitante.
+class InferenceService {
+public:
+    struct Result {
+        std::vector<Detection> detections;
+        int inputSize = 0; // lado da entrada da rede usada no lote
+        int batchSize = 0; // frames no forward
+    };
+
+    InferenceService(const std::string& modelPath, float confThreshold = 0.5f,
+                     int maxBatch = 4, int windowMs = 5,
+                     const BackendConfig& backendConfig = BackendConfig());
+    ~InferenceService();
+
+    // Instância única por modelo + configuração do backend, criada sob demanda
+    static std::shared_ptr<InferenceService> shared(const std::string& modelPath,
+                                                    const BackendConfig& backendConfig = BackendConfig());
+
+    // Entrada adaptativa por pedido (como YOLODetector::setTargetHint e
+    // setLatencyBudget): o lote usa a maior entrada pedida pelos frames
+    std::future<Result> submit(const cv::Mat& frame, float targetHintPx = 0, double budgetMs = 0);
+    // Maior entrada que o próximo lote pode usar (recorte do ROI)
+    cv::Size upcomingInputSize(double budgetMs) const;
+
+    void setConfidenceThreshold(float threshold);
+    void setInputSizes(const std::vector<int>& sizes);
+    void setLetterbox(bool enabled);
+    std::string backendName() const;
+
+    // Câmeras ativas: o lote sai assim que todas enviaram um frame
+    void registerClient();
+    void unregisterClient();
+
+private:
+    struct Request {
+        cv::Mat frame;
+        float targetHintPx;
+        double budgetMs;
+        std::promise<Result> result;
+    };
+
+    void run();
+
+    // Usado só pelo worker, exceto nos setters (sob detectorMutex)
+    std::unique_ptr<YOLODetector> detector;
+    mutable std::mutex detectorMutex;
+    int maxBatch;
+    std::chrono::milliseconds window;
+
+    // Entrada do último lote, lida pelas engines sem esperar o forward
+    std::atomic<int> activeSide;
+    std::atomic<int> largestSide;
+    std::atomic<bool> adaptive;
+
+    int clients;
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<Request> pending;
+    std::thread worker;
+};
+
+#endif
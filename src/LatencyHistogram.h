@@ -0,0 +1,85 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Histograma de latência log-linear (estilo HDR) em microssegundos.
+// record() é lock-free e pode ser chamado pela thread do estágio enquanto
+// outra thread drena a janela com takeSnapshot(). Valores abaixo de 64 us
+// são exatos; acima disso a resolução é de ~3% (32 sub-buckets por oitava).
+class LatencyHistogram {
+public:
+    static constexpr int kSubBuckets = 32;
+    static constexpr int kLinear = 2 * kSubBuckets;
+    static constexpr int kBuckets = kLinear + 26 * kSubBuckets; // até 2^32 us (~71 min)
+
+    struct Snapshot {
+        std::array<uint64_t, kBuckets> counts{};
+        uint64_t count = 0;
+        uint64_t maxUs = 0;
+
+        // Percentil em milissegundos (ponto médio do bucket)
+        double percentileMs(double p) const {
+            if (count == 0) return 0.0;
+            uint64_t rank = (uint64_t)(p / 100.0 * (count - 1)) + 1;
+            uint64_t seen = 0;
+            for (int i = 0; i < kBuckets; i++) {
+                seen += counts[i];
+                if (seen >= rank) return bucketMidUs(i) / 1000.0;
+            }
+            return maxUs / 1000.0;
+        }
+    };
+
+    LatencyHistogram() {
+        for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+    }
+
+    void record(uint64_t us) {
+        counts[bucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t prev = maxUs.load(std::memory_order_relaxed);
+        while (us > prev && !maxUs.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Lê e zera a janela atual
+    Snapshot takeSnapshot() {
+        Snapshot snap;
+        for (int i = 0; i < kBuckets; i++) {
+            snap.counts[i] = counts[i].exchange(0, std::memory_order_relaxed);
+            snap.count += snap.counts[i];
+        }
+        snap.maxUs = maxUs.exchange(0, std::memory_order_relaxed);
+        return snap;
+    }
+
+    static int bucketIndex(uint64_t us) {
+        if (us < (uint64_t)kLinear) return (int)us;
+        int msb = highestBit(us);
+        int shift = msb - 5;
+        int index = kLinear + (msb - 6) * kSubBuckets + (int)((us >> shift) - kSubBuckets);
+        return index < kBuckets ? index : kBuckets - 1;
+    }
+
+    static double bucketMidUs(int index) {
+        if (index < kLinear) return index;
+        int group = (index - kLinear) / kSubBuckets;
+        int mantissa = (index - kLinear) % kSubBuckets + kSubBuckets;
+        int shift = group + 1;
+        return (double)((uint64_t)mantissa << shift) + ((uint64_t)1 << shift) / 2.0;
+    }
+
+private:
+    static int highestBit(uint64_t v) {
+        int bit = 0;
+        while (v >>= 1) bit++;
+        return bit;
+    }
+
+    std::array<std::atomic<uint64_t>, kBuckets> counts;
+    std::atomic<uint64_t> maxUs{0};
+};
+
+#endif
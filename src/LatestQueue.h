@@ -0,0 +1,85 @@
+#ifndef LATESTQUEUE_H
+#define LATESTQUEUE_H
+
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <cstdint>
+
+// Fila limitada "latest-wins" entre estágios do pipeline.
+// Quando cheia, o item mais antigo é descartado para que o consumidor
+// sempre receba o dado mais recente.
+template <typename T>
+class LatestQueue {
+public:
+    explicit LatestQueue(size_t capacity = 1)
+        : capacity(capacity ? capacity : 1), closed(false), dropped(0) {}
+
+    void push(T item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed) return;
+            while (items.size() >= capacity) {
+                items.pop_front();
+                dropped++;
+            }
+            items.push_back(std::move(item));
+        }
+        cond.notify_one();
+    }
+
+    // Bloqueia até haver item; retorna false quando a fila foi fechada
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [this]() { return closed || !items.empty(); });
+        if (items.empty()) return false;
+        out = std::move(items.front());
+        items.pop_front();
+        return true;
+    }
+
+    bool tryPop(T& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty()) return false;
+        out = std::move(items.front());
+        items.pop_front();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        cond.notify_all();
+    }
+
+    // Esvazia e reabre a fila para um novo ciclo start/stop
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.clear();
+        closed = false;
+        dropped = 0;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.size();
+    }
+
+    uint64_t droppedCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return dropped;
+    }
+
+private:
+    size_t capacity;
+    bool closed;
+    uint64_t dropped;
+    std::deque<T> items;
+    mutable std::mutex mutex;
+    std::condition_variable cond;
+};
+
+#endif
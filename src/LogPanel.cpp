@@ -4,8 +4,42 @@
 #include <QDateTime>
 #include <QScrollBar>
 #include <QLabel>
+#include <algorithm>
 
-LogPanel::LogPanel(QWidget *parent) : QWidget(parent), logCount(0) {
+namespace {
+
+constexpr int kDrainIntervalMs = 100;
+constexpr int kMaxEntriesPerDrain = 2000; // Limita o tempo de um lote na GUI
+
+QString levelColor(int level) {
+    switch (level) {
+        case 1: return "#4CAF50"; // Success
+        case 2: return "#f44336"; // Error
+        case 3: return "#FF9800"; // Warning
+        default: return "#888";   // Info
+    }
+}
+
+QString levelIcon(int level) {
+    switch (level) {
+        case 0: return "ℹ";
+        case 1: return "✓";
+        case 2: return "✗";
+        case 3: return "⚠";
+        default: return "•";
+    }
+}
+
+QString timeText(qint64 timeMs) {
+    return QDateTime::fromMSecsSinceEpoch(timeMs).toString("HH:mm:ss.zzz");
+}
+
+}
+
+LogPanel::LogPanel(QWidget *parent)
+    : QWidget(parent), max_lines_per_second(50), mirror_max_bytes(10 << 20), mirror_keep(5),
+      logCount(0), lineBudget(0), lastDrainMs(0), suppressed(0), repeatCount(0), repeatFlushMs(0)
+{
     QVBoxLayout *layout = new QVBoxLayout(this);
     layout->setSpacing(5);
     
@@ -41,49 +75,132 @@ LogPanel::LogPanel(QWidget *parent) : QWidget(parent), logCount(0) {
     )");
     
     layout->addWidget(logText);
+    
+    drainTimer = new QTimer(this);
+    connect(drainTimer, &QTimer::timeout, this, &LogPanel::drain);
+    drainTimer->start(kDrainIntervalMs);
 }
 
 void LogPanel::addLog(const QString &msg, int level) {
-    QString color;
-    QString icon;
+    LogRing::post(level, msg);
+}
+
+void LogPanel::drain() {
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    double elapsed = lastDrainMs > 0 ? (now - lastDrainMs) / 1000.0 : 1.0;
+    lastDrainMs = now;
+    lineBudget = std::min<double>(max_lines_per_second, lineBudget + elapsed * max_lines_per_second);
     
-    switch (level) {
-        case 0:  // Info
-            color = "#888";
-            icon = "ℹ";
-            break;
-        case 1:  // Success
-            color = "#4CAF50";
-            icon = "✓";
-            break;
-        case 2:  // Error
-            color = "#f44336";
-            icon = "✗";
-            break;
-        case 3:  // Warning
-            color = "#FF9800";
-            icon = "⚠";
-            break;
-        default:
-            color = "#888";
-            icon = "•";
-    }
+    LogRing &ring = LogRing::instance();
+    LogEntry entry;
+    int count = 0;
+    bool shown = false;
     
-    QString time = QDateTime::currentDateTime().toString("HH:mm:ss.zzz");
-    QString html = QString("<span style='color:%1'>[%2] %3 %4</span>")
-        .arg(color, time, icon, msg.toHtmlEscaped());
+    // Uma repintura e um ajuste de scroll por lote, não por linha
+    logText->setUpdatesEnabled(false);
+    while (count < kMaxEntriesPerDrain && ring.pop(entry)) {
+        count++;
+        writeMirror(entry);
+        if (entry.level == 4) continue; // Depuração: só no arquivo, fora do limite
+        
+        if (!lastEntry.text.isEmpty() &&
+            entry.level == lastEntry.level && entry.text == lastEntry.text) {
+            repeatCount++;
+            lastEntry.timeMs = entry.timeMs;
+            continue;
+        }
+        flushRepeats();
+        
+        // Erros e avisos sempre passam; o limite é para o fluxo de info
+        if (entry.level != 2 && entry.level != 3 && lineBudget < 1.0) {
+            suppressed++;
+            continue;
+        }
+        if (suppressed > 0) {
+            appendLine({entry.timeMs, 3, QString("%1 mensagens omitidas (limite de %2/s)")
+                .arg(suppressed).arg(max_lines_per_second)});
+            suppressed = 0;
+        }
+        lineBudget -= 1.0;
+        appendLine(entry);
+        lastEntry = std::move(entry);
+        shown = true;
+    }
     
-    logText->appendHtml(html);
+    // Repetição contínua: um resumo por segundo em vez de silêncio
+    if (repeatCount > 0 && now - repeatFlushMs >= 1000) {
+        flushRepeats();
+        repeatFlushMs = now;
+        shown = true;
+    }
     
-    // Auto-scroll
-    QScrollBar *sb = logText->verticalScrollBar();
-    sb->setValue(sb->maximum());
+    uint64_t lost = ring.takeDropped();
+    if (lost > 0) {
+        appendLine({now, 3, QString("%1 mensagens perdidas (anel de log cheio)").arg(lost)});
+        shown = true;
+    }
+    logText->setUpdatesEnabled(true);
     
+    if (shown) {
+        QScrollBar *sb = logText->verticalScrollBar();
+        sb->setValue(sb->maximum());
+    }
+    if (count > 0 && mirror.isOpen()) {
+        mirror.flush();
+    }
+}
+
+void LogPanel::flushRepeats() {
+    if (repeatCount > 0) {
+        appendLine({lastEntry.timeMs, lastEntry.level,
+                    QString("↑ repetida %1×").arg(repeatCount)});
+    }
+    repeatCount = 0;
+}
+
+void LogPanel::appendLine(const LogEntry &entry) {
+    QString html = QString("<span style='color:%1'>[%2] %3 %4</span>")
+        .arg(levelColor(entry.level), timeText(entry.timeMs), levelIcon(entry.level),
+             entry.text.toHtmlEscaped());
+    logText->appendHtml(html);
     logCount++;
 }
 
 void LogPanel::clear() {
     logText->clear();
     logCount = 0;
+    repeatCount = 0;
+    lastEntry = LogEntry();
     addLog("Logs limpos", 0);
 }
+
+bool LogPanel::setMirrorFile(const QString &path) {
+    mirror.close();
+    mirrorPath = path;
+    if (path.isEmpty()) return true;
+    
+    mirror.setFileName(path);
+    return mirror.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+}
+
+void LogPanel::writeMirror(const LogEntry &entry) {
+    if (!mirror.isOpen()) return;
+    
+    QByteArray line = QString("%1 [%2] %3\n")
+        .arg(timeText(entry.timeMs), levelIcon(entry.level), entry.text).toUtf8();
+    mirror.write(line);
+    if (mirror.size() >= mirror_max_bytes) {
+        rotateMirror();
+    }
+}
+
+void LogPanel::rotateMirror() {
+    // path -> path.1 -> ... -> path.N (o mais antigo é apagado)
+    mirror.close();
+    QFile::remove(QString("%1.%2").arg(mirrorPath).arg(mirror_keep));
+    for (int i = mirror_keep - 1; i >= 1; i--) {
+        QFile::rename(QString("%1.%2").arg(mirrorPath).arg(i), QString("%1.%2").arg(mirrorPath).arg(i + 1));
+    }
+    QFile::rename(mirrorPath, mirrorPath + ".1");
+    mirror.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+}
@@ -4,19 +4,54 @@
 #include <QWidget>
 #include <QPlainTextEdit>
 #include <QPushButton>
+#include <QFile>
+#include <QTimer>
+#include "LogRing.h"
 
+// Painel de log. As mensagens chegam pelo LogRing (de qualquer thread) e
+// são drenadas em lote por um timer: repetições seguidas viram uma linha
+// só e o excesso acima de max_lines_per_second é resumido. O espelho em
+// arquivo, quando ligado, recebe tudo, inclusive o nível 4 (depuração),
+// que nunca aparece no painel.
 class LogPanel : public QWidget {
     Q_OBJECT
 
 public:
     explicit LogPanel(QWidget *parent = nullptr);
+    // Atalho para LogRing::post (aparece no próximo lote)
     void addLog(const QString &msg, int level);
     void clear();
+    // Espelha o log em arquivo com rotação (path.1 .. path.N); vazio desliga
+    bool setMirrorFile(const QString &path);
+    
+    int max_lines_per_second;
+    qint64 mirror_max_bytes;
+    int mirror_keep;
 
 private:
+    void drain();
+    void appendLine(const LogEntry &entry);
+    void flushRepeats();
+    void writeMirror(const LogEntry &entry);
+    void rotateMirror();
+    
     QPlainTextEdit *logText;
     QPushButton *clearBtn;
+    QTimer *drainTimer;
     int logCount;
+    
+    // Limite de linhas: balde de fichas recarregado a cada lote
+    double lineBudget;
+    qint64 lastDrainMs;
+    int suppressed;
+    
+    // Repetição da última mensagem exibida
+    LogEntry lastEntry;
+    int repeatCount;
+    qint64 repeatFlushMs;
+    
+    QFile mirror;
+    QString mirrorPath;
 };
 
 #endif
@@ -0,0 +1,74 @@
+#include "LogRing.h"
+#include <QDateTime>
+
+namespace {
+std::atomic<bool> debugOn{false};
+}
+
+LogRing::LogRing(size_t capacity) : enqueuePos(0), dequeuePos(0), dropped(0) {
+    size_t size = 2;
+    while (size < capacity) size *= 2;
+    mask = size - 1;
+    
+    cells = std::make_unique<Cell[]>(size);
+    for (size_t i = 0; i < size; i++) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+LogRing& LogRing::instance() {
+    static LogRing ring;
+    return ring;
+}
+
+bool LogRing::debugEnabled() {
+    return debugOn.load(std::memory_order_relaxed);
+}
+
+void LogRing::setDebugEnabled(bool enabled) {
+    debugOn.store(enabled, std::memory_order_relaxed);
+}
+
+void LogRing::post(int level, const QString& text) {
+    LogEntry entry;
+    entry.timeMs = QDateTime::currentMSecsSinceEpoch();
+    entry.level = level;
+    entry.text = text;
+    instance().push(std::move(entry));
+}
+
+bool LogRing::push(LogEntry entry) {
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+        cell = &cells[pos & mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            // Célula livre nesta volta: reserva a posição
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed); // Cheio: o consumidor ainda não leu
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed); // Outro produtor passou na frente
+        }
+    }
+    
+    // A célula já foi esvaziada pelo consumidor: atribuição sem alocar
+    cell->entry = std::move(entry);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogRing::pop(LogEntry& entry) {
+    Cell& cell = cells[dequeuePos & mask];
+    size_t seq = cell.sequence.load(std::memory_order_acquire);
+    if ((intptr_t)seq - (intptr_t)(dequeuePos + 1) < 0) return false;
+    
+    entry = std::move(cell.entry);
+    cell.entry.text = QString(); // Libera o texto aqui, não no produtor
+    cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+    dequeuePos++;
+    return true;
+}
@@ -0,0 +1,51 @@
+#ifndef LOGRING_H
+#define LOGRING_H
+
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Mensagem de log: nível no mesmo código do LogPanel
+// (0 info, 1 sucesso, 2 erro, 3 aviso, 4 depuração: só no arquivo)
+struct LogEntry {
+    qint64 timeMs = 0; // epoch em ms, marcado por quem gerou
+    int level = 0;
+    QString text;
+};
+
+// Anel de log lock-free com vários produtores e um consumidor (o LogPanel).
+// Qualquer thread grava sem sinal, mutex ou alocação no anel; cheio, a
+// mensagem é descartada e contada em vez de bloquear quem está logando.
+// Células com número de sequência (fila limitada de Vyukov).
+class LogRing {
+public:
+    explicit LogRing(size_t capacity = 4096); // arredondado para potência de 2
+    
+    // Anel global usado por post() e drenado pelo LogPanel
+    static LogRing& instance();
+    static void post(int level, const QString& text);
+    // Nível 4 (por comando, alta taxa): quem loga testa antes de montar o texto
+    static bool debugEnabled();
+    static void setDebugEnabled(bool enabled);
+    
+    bool push(LogEntry entry);
+    // Só o consumidor chama; false quando vazio
+    bool pop(LogEntry& entry);
+    // Descartadas por anel cheio desde a última chamada
+    uint64_t takeDropped() { return dropped.exchange(0); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        LogEntry entry;
+    };
+    
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) size_t dequeuePos;
+    std::atomic<uint64_t> dropped;
+};
+
+#endif
@@ -4,6 +4,9 @@
 #include "LogPanel.h"
 #include "CaptureEngine.h"
 #include "PTZController.h"
+#include "SessionRecorder.h"
+#include "InferenceBackend.h"
+#include "InferenceService.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -14,9 +17,12 @@
 #include <QSerialPortInfo>
 #include <QMessageBox>
 #include <QTimer>
+#include <QFileDialog>
+#include <QAction>
+#include <QFileInfo>
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), isRunning(false)
+    : QMainWindow(parent), isRunning(false), ptzAckMs(0.0), ptzCompletionMs(0.0)
 {
     setWindowTitle("PTZ Person Tracker Pro - v2.0 (YOLO)");
     resize(1400, 900);
@@ -57,14 +63,47 @@ void MainWindow::setupUI() {
     for (const auto &info : QSerialPortInfo::availablePorts()) {
         comPortCombo->addItem(info.portName());
     }
+    // Câmeras VISCA over IP: digite udp://ip[:porta]
+    comPortCombo->setEditable(true);
+    comPortCombo->setToolTip("Porta serial ou udp://ip[:52381] para VISCA over IP");
     controlLayout->addWidget(comPortCombo);
     
+    controlLayout->addWidget(new QLabel("Backend:"));
+    backendCombo = new QComboBox();
+    for (const auto &name : InferenceBackend::available()) {
+        backendCombo->addItem(QString::fromStdString(name));
+    }
+    controlLayout->addWidget(backendCombo);
+    
+    backendThreadsSpinBox = new QSpinBox();
+    backendThreadsSpinBox->setRange(0, 64);
+    backendThreadsSpinBox->setValue(0);
+    backendThreadsSpinBox->setPrefix("threads ");
+    backendThreadsSpinBox->setSpecialValueText("threads auto");
+    backendThreadsSpinBox->setToolTip("Threads do backend (0 = padrão do runtime). No OpenCV o pool "
+                                      "é do processo inteiro: vale também para a decodificação");
+    controlLayout->addWidget(backendThreadsSpinBox);
+    
+    graphOptCheckbox = new QCheckBox("Otimizar grafo");
+    graphOptCheckbox->setToolTip("Fusão/otimização do grafo no carregamento do modelo");
+    graphOptCheckbox->setChecked(true);
+    controlLayout->addWidget(graphOptCheckbox);
+    
     controlLayout->addWidget(new QLabel("FPS:"));
     fpsSpinBox = new QSpinBox();
     fpsSpinBox->setRange(1, 60);
     fpsSpinBox->setValue(30);
     controlLayout->addWidget(fpsSpinBox);
     
+    controlLayout->addWidget(new QLabel("Resolução:"));
+    resolutionCombo = new QComboBox();
+    resolutionCombo->addItem("640x480", QSize(640, 480));
+    resolutionCombo->addItem("1280x720", QSize(1280, 720));
+    resolutionCombo->addItem("1920x1080", QSize(1920, 1080));
+    resolutionCombo->setToolTip("Resolução pedida à câmera; acima de 640 px o MJPEG é "
+                                "decodificado já reduzido (1/2, 1/4)");
+    controlLayout->addWidget(resolutionCombo);
+    
     controlLayout->addWidget(new QLabel("Precisão:"));
     thresholdSpinBox = new QDoubleSpinBox();
     thresholdSpinBox->setRange(0.1, 0.9);
@@ -80,6 +119,35 @@ void MainWindow::setupUI() {
     });
     controlLayout->addWidget(thresholdSpinBox);
     
+    controlLayout->addWidget(new QLabel("Keyframe:"));
+    keyframeSpinBox = new QSpinBox();
+    keyframeSpinBox->setRange(1, 10);
+    keyframeSpinBox->setValue(1);
+    keyframeSpinBox->setToolTip("Roda o YOLO a cada N frames e rastreia as caixas entre eles");
+    connect(keyframeSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            [this](int val) {
+        if (captureEngine) {
+            captureEngine->setKeyframeInterval(val);
+        }
+    });
+    controlLayout->addWidget(keyframeSpinBox);
+    
+    controlLayout->addWidget(new QLabel("Orçamento:"));
+    budgetSpinBox = new QSpinBox();
+    budgetSpinBox->setRange(0, 200);
+    budgetSpinBox->setValue(0);
+    budgetSpinBox->setSuffix(" ms");
+    budgetSpinBox->setSpecialValueText("fixo");
+    budgetSpinBox->setToolTip("Custo máximo da inferência por frame: a entrada da rede varia de 256 a 640 "
+                              "conforme o custo medido e o tamanho do alvo");
+    connect(budgetSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+            [this](int val) {
+        if (captureEngine) {
+            captureEngine->setInferenceBudget(val);
+        }
+    });
+    controlLayout->addWidget(budgetSpinBox);
+    
     autoTrackCheckbox = new QCheckBox("Auto PTZ");
     connect(autoTrackCheckbox, &QCheckBox::toggled, [this](bool checked) {
         if (captureEngine) {
@@ -92,6 +160,42 @@ void MainWindow::setupUI() {
     });
     controlLayout->addWidget(autoTrackCheckbox);
     
+    autoZoomCheckbox = new QCheckBox("Auto Zoom");
+    autoZoomCheckbox->setToolTip("Mantém o alvo num tamanho constante no quadro (requer Auto PTZ)");
+    connect(autoZoomCheckbox, &QCheckBox::toggled, [this](bool checked) {
+        if (captureEngine) {
+            captureEngine->setAutoZoom(checked);
+        }
+    });
+    controlLayout->addWidget(autoZoomCheckbox);
+    
+    roiCheckbox = new QCheckBox("ROI");
+    roiCheckbox->setToolTip("Detecta num recorte em torno do alvo, com varredura completa periódica");
+    connect(roiCheckbox, &QCheckBox::toggled, [this](bool checked) {
+        if (captureEngine) {
+            captureEngine->setRoiMode(checked);
+        }
+    });
+    controlLayout->addWidget(roiCheckbox);
+    
+    motionGateCheckbox = new QCheckBox("Movimento");
+    motionGateCheckbox->setToolTip("Pula o YOLO quando a cena está parada e não há ninguém rastreado "
+                                   "(detecção de garantia a cada 2 s)");
+    connect(motionGateCheckbox, &QCheckBox::toggled, [this](bool checked) {
+        if (captureEngine) {
+            captureEngine->setMotionGate(checked);
+        }
+    });
+    controlLayout->addWidget(motionGateCheckbox);
+    
+    overlayCheckbox = new QCheckBox("Caixas");
+    overlayCheckbox->setToolTip("Mostra caixas, IDs e confiança sobre o vídeo (só na tela)");
+    overlayCheckbox->setChecked(true);
+    connect(overlayCheckbox, &QCheckBox::toggled, [this](bool checked) {
+        videoWidget->setOverlayVisible(checked);
+    });
+    controlLayout->addWidget(overlayCheckbox);
+    
     mainLayout->addWidget(controlGroup);
     
     QSplitter *splitter = new QSplitter(Qt::Horizontal);
@@ -199,6 +303,42 @@ void MainWindow::createMenuBar() {
     QMenuBar *menuBar = new QMenuBar(this);
     
     QMenu *fileMenu = menuBar->addMenu("&Arquivo");
+    fileMenu->addAction("Câmera &simulada...", [this]() {
+        QString path = QFileDialog::getOpenFileName(this, "Panorama ou vídeo para a câmera simulada",
+            QString(), "Mídia (*.jpg *.jpeg *.png *.bmp *.mp4 *.avi *.mkv *.mov)");
+        if (path.isEmpty()) return;
+        // A fonte "sim:" é comandada pela porta PTZ "sim"
+        webcamCombo->addItem("🧪 Simulação: " + QFileInfo(path).fileName(), "sim:" + path);
+        webcamCombo->setCurrentIndex(webcamCombo->count() - 1);
+        comPortCombo->setCurrentText("sim");
+        logPanel->addLog("Câmera simulada: " + path, 0);
+    });
+    QAction *mirrorAction = fileMenu->addAction("Salvar &log em arquivo...");
+    mirrorAction->setCheckable(true);
+    connect(mirrorAction, &QAction::toggled, this, [this, mirrorAction](bool checked) {
+        QString path;
+        if (checked) {
+            path = QFileDialog::getSaveFileName(this, "Salvar log", "ptztracker.log", "Log (*.log *.txt)");
+        }
+        if (!logPanel->setMirrorFile(path) || (checked && path.isEmpty())) {
+            if (!path.isEmpty()) logPanel->addLog("Falha ao abrir " + path, 2);
+            QSignalBlocker blocker(mirrorAction);
+            mirrorAction->setChecked(false);
+            logPanel->setMirrorFile(QString());
+            return;
+        }
+        if (checked) logPanel->addLog("Log espelhado em " + path + " (rotação a cada 10 MB)", 1);
+    });
+    // Um registro por comando (50/s): só vai para o arquivo, nunca para o painel
+    QAction *viscaLogAction = fileMenu->addAction("Comandos &VISCA no arquivo de log");
+    viscaLogAction->setCheckable(true);
+    connect(viscaLogAction, &QAction::toggled, this, [](bool checked) {
+        LogRing::setDebugEnabled(checked);
+    });
+    recordAction = fileMenu->addAction("&Gravar sessão...");
+    recordAction->setCheckable(true);
+    connect(recordAction, &QAction::toggled, this, &MainWindow::setRecording);
+    fileMenu->addSeparator();
     fileMenu->addAction("&Sair", this, &QWidget::close);
     
     QMenu *helpMenu = menuBar->addMenu("&Ajuda");
@@ -220,8 +360,10 @@ void MainWindow::createStatusBar() {
     statusLabel = new QLabel("Pronto");
     fpsLabel = new QLabel("FPS: --");
     detectionLabel = new QLabel("Detecções: 0");
+    latencyLabel = new QLabel("⏱ --");
     
     statusBar()->addWidget(statusLabel, 1);
+    statusBar()->addPermanentWidget(latencyLabel);
     statusBar()->addPermanentWidget(detectionLabel);
     statusBar()->addPermanentWidget(fpsLabel);
 }
@@ -229,27 +371,57 @@ void MainWindow::createStatusBar() {
 void MainWindow::onStartClicked() {
     if (isRunning) return;
     
-    int cameraIndex = webcamCombo->currentData().toInt();
+    QString source = webcamCombo->currentData().toString();
     
-    if (cameraIndex < 0) {
+    if (!source.startsWith("sim:") && webcamCombo->currentData().toInt() < 0) {
         QMessageBox::warning(this, "Erro", "Nenhuma webcam selecionada ou disponível!");
         return;
     }
     
     logPanel->addLog("🚀 Iniciando captura com YOLO...", 1);
     
-    captureEngine = std::make_unique<CaptureEngine>(
-        std::to_string(cameraIndex),
-        fpsSpinBox->value(),
-        thresholdSpinBox->value()
-    );
-    
+    BackendConfig backendConfig;
+    backendConfig.type = backendCombo->currentText().toStdString();
+    backendConfig.threads = backendThreadsSpinBox->value();
+    backendConfig.optimizeGraph = graphOptCheckbox->isChecked();
+    
+    try {
+        // Detector compartilhado por modelo + backend: câmeras do mesmo
+        // processo entram no mesmo forward em lote
+        captureEngine = std::make_unique<CaptureEngine>(
+            source.toStdString(),
+            fpsSpinBox->value(),
+            thresholdSpinBox->value(),
+            backendConfig,
+            InferenceService::shared("yolov8n.onnx", backendConfig)
+        );
+    } catch (const std::exception &e) {
+        logPanel->addLog(QString("Falha ao iniciar a captura: %1").arg(e.what()), 2);
+        QMessageBox::warning(this, "Erro", QString("Falha ao iniciar a captura:\n%1").arg(e.what()));
+        return;
+    }
+    logPanel->addLog(QString("Backend de inferência: %1 (threads %2, grafo %3)")
+        .arg(backendCombo->currentText())
+        .arg(backendConfig.threads > 0 ? QString::number(backendConfig.threads) : QString("auto"))
+        .arg(backendConfig.optimizeGraph ? "otimizado" : "sem otimização"), 0);
+    
+    CaptureConfig captureConfig;
+    QSize resolution = resolutionCombo->currentData().toSize();
+    captureConfig.resolution = cv::Size(resolution.width(), resolution.height());
+    captureEngine->setCaptureConfig(captureConfig);
     captureEngine->setAutoTracking(autoTrackCheckbox->isChecked());
+    captureEngine->setAutoZoom(autoZoomCheckbox->isChecked());
+    captureEngine->setKeyframeInterval(keyframeSpinBox->value());
+    captureEngine->setInferenceBudget(budgetSpinBox->value());
+    captureEngine->setRoiMode(roiCheckbox->isChecked());
+    captureEngine->setMotionGate(motionGateCheckbox->isChecked());
+    captureEngine->setRecorder(sessionRecorder);
     
     if (comPortCombo->currentText() != "Desabilitado") {
         ptzController = std::make_unique<PTZController>(
             comPortCombo->currentText().toStdString(), 9600
         );
+        ptzController->setRecorder(sessionRecorder);
         ptzPanel->setEnabled(true);
         
         connect(ptzPanel, &PTZPanel::panTiltRequested, 
@@ -263,6 +435,17 @@ void MainWindow::onStartClicked() {
         
         connect(captureEngine.get(), &CaptureEngine::ptzAdjustmentNeeded,
                 ptzController.get(), &PTZController::panTilt);
+        connect(captureEngine.get(), &CaptureEngine::zoomAdjustmentNeeded,
+                ptzController.get(), &PTZController::zoom);
+        
+        connect(ptzController.get(), &PTZController::error, this, [this](const QString &msg) {
+            logPanel->addLog(msg, 2);
+        });
+        connect(ptzController.get(), &PTZController::roundTripMeasured,
+                this, &MainWindow::onPtzRoundTrip);
+        // O RTT do ACK alimenta a compensação de latência do controle
+        connect(ptzController.get(), &PTZController::roundTripMeasured,
+                captureEngine.get(), &CaptureEngine::setActuationDelay);
         
         logPanel->addLog("✓ PTZ conectado", 1);
     }
@@ -271,6 +454,8 @@ void MainWindow::onStartClicked() {
             this, &MainWindow::onFrameReady);
     connect(captureEngine.get(), &CaptureEngine::fpsUpdated,
             this, &MainWindow::onFPSUpdate);
+    connect(captureEngine.get(), &CaptureEngine::telemetryUpdated,
+            this, &MainWindow::onTelemetryUpdate);
     connect(captureEngine.get(), &CaptureEngine::detectionCount,
             this, &MainWindow::onDetectionCount);
     
@@ -297,18 +482,62 @@ void MainWindow::onStopClicked() {
     updateUIState(false);
     statusLabel->setText("⏹ Parado");
     fpsLabel->setText("FPS: --");
+    latencyLabel->setText("⏱ --");
+    latencyLabel->setToolTip(QString());
+    ptzAckMs = 0.0;
+    ptzCompletionMs = 0.0;
     detectionLabel->setText("Detecções: 0");
     logPanel->addLog("⏹ Captura encerrada", 0);
 }
 
-void MainWindow::onFrameReady(const QImage &frame) {
-    videoWidget->setFrame(frame);
+void MainWindow::onFrameReady(const QImage &frame, const FrameOverlay &overlay) {
+    videoWidget->setFrame(frame, overlay);
 }
 
 void MainWindow::onFPSUpdate(double fps) {
     fpsLabel->setText(QString("FPS: %1").arg(fps, 0, 'f', 1));
 }
 
+void MainWindow::onTelemetryUpdate(const PipelineTelemetry &t) {
+    quint64 dropped = t.droppedInfer + t.droppedControl + t.droppedRender;
+    latencyLabel->setText(QString("⏱ inf %1 | ctl %2 | ren %3 | e2e %4 ms (p95) | drop %5")
+        .arg(t.inference.p95Ms, 0, 'f', 1)
+        .arg(t.control.p95Ms, 0, 'f', 1)
+        .arg(t.render.p95Ms, 0, 'f', 1)
+        .arg(t.endToEnd.p95Ms, 0, 'f', 1)
+        .arg(dropped));
+    
+    auto row = [](const char *name, const StageLatency &s) {
+        return QString("%1: p50 %2 / p95 %3 / p99 %4 / max %5 ms (%6)\n")
+            .arg(name)
+            .arg(s.p50Ms, 0, 'f', 1).arg(s.p95Ms, 0, 'f', 1)
+            .arg(s.p99Ms, 0, 'f', 1).arg(s.maxMs, 0, 'f', 1)
+            .arg(s.count);
+    };
+    latencyLabel->setToolTip(
+        row("Captura", t.capture) +
+        row("Fila", t.queueWait) +
+        row("Inferência", t.inference) +
+        row("Controle", t.control) +
+        row("Render", t.render) +
+        row("Ponta a ponta", t.endToEnd) +
+        row("Compensação", t.compensation) +
+        QString("Descartados: inf %1 / ctl %2 / ren %3\nFilas: %4 / %5 / %6")
+            .arg(t.droppedInfer).arg(t.droppedControl).arg(t.droppedRender)
+            .arg(t.inferQueueDepth).arg(t.controlQueueDepth).arg(t.renderQueueDepth) +
+        (t.gatedFrames > 0 ? QString("\nSem inferência (cena parada): %1 frames").arg(t.gatedFrames) : QString()) +
+        (t.inputSize > 0 ? QString("\nEntrada da rede: %1 px").arg(t.inputSize) : QString()) +
+        (t.ingest.isEmpty() ? QString() : QString("\nCâmera: %1").arg(t.ingest)) +
+        (ptzAckMs > 0 ? QString("\nPTZ RTT: ACK %1 / conclusão %2 ms")
+            .arg(ptzAckMs, 0, 'f', 1).arg(ptzCompletionMs, 0, 'f', 1) : QString()));
+}
+
+void MainWindow::onPtzRoundTrip(double ackMs, double completionMs) {
+    const double alpha = 0.2;
+    ptzAckMs = ptzAckMs > 0 ? ptzAckMs + alpha * (ackMs - ptzAckMs) : ackMs;
+    ptzCompletionMs = ptzCompletionMs > 0 ? ptzCompletionMs + alpha * (completionMs - ptzCompletionMs) : completionMs;
+}
+
 void MainWindow::onDetectionCount(int count) {
     detectionLabel->setText(QString("👤 Detecções: %1").arg(count));
 }
@@ -318,5 +547,38 @@ void MainWindow::updateUIState(bool running) {
     stopButton->setEnabled(running);
     webcamCombo->setEnabled(!running);
     comPortCombo->setEnabled(!running);
+    backendCombo->setEnabled(!running);
+    backendThreadsSpinBox->setEnabled(!running);
+    graphOptCheckbox->setEnabled(!running);
     fpsSpinBox->setEnabled(!running);
-}
\ No newline at end of file
+    resolutionCombo->setEnabled(!running);
+}
+
+void MainWindow::setRecording(bool enabled) {
+    if (enabled) {
+        QString path = QFileDialog::getSaveFileName(this, "Gravar sessão",
+            "sessao.ptzsess", "Sessão PTZ (*.ptzsess)");
+        auto recorder = std::make_shared<SessionRecorder>();
+        if (path.isEmpty() || !recorder->open(path)) {
+            if (!path.isEmpty()) logPanel->addLog("Falha ao criar " + path, 2);
+            QSignalBlocker blocker(recordAction);
+            recordAction->setChecked(false);
+            return;
+        }
+        sessionRecorder = std::move(recorder);
+        logPanel->addLog("⏺ Gravando sessão em " + path, 1);
+    } else if (sessionRecorder) {
+        // Desliga o pipeline antes de fechar: close() espera a fila esvaziar
+        if (captureEngine) captureEngine->setRecorder(nullptr);
+        if (ptzController) ptzController->setRecorder(nullptr);
+        sessionRecorder->close();
+        logPanel->addLog(QString("⏹ Sessão gravada: %1 MB, %2 frames descartados")
+            .arg(sessionRecorder->bytesWritten() / 1e6, 0, 'f', 1)
+            .arg(sessionRecorder->droppedFrames()), 0);
+        sessionRecorder.reset();
+        return;
+    }
+    
+    if (captureEngine) captureEngine->setRecorder(sessionRecorder);
+    if (ptzController) ptzController->setRecorder(sessionRecorder);
+}
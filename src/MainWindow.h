@@ -10,12 +10,15 @@
 #include <QLabel>
 #include <memory>
 #include <opencv2/opencv.hpp>
+#include "CaptureEngine.h"
 
 class VideoWidget;
 class PTZPanel;
 class LogPanel;
 class CaptureEngine;
 class PTZController;
+class SessionRecorder;
+class QAction;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -27,9 +30,11 @@ public:
 private slots:
     void onStartClicked();
     void onStopClicked();
-    void onFrameReady(const QImage &frame);
+    void onFrameReady(const QImage &frame, const FrameOverlay &overlay);
     void onFPSUpdate(double fps);
+    void onTelemetryUpdate(const PipelineTelemetry &telemetry);
     void onDetectionCount(int count);
+    void onPtzRoundTrip(double ackMs, double completionMs);
     void refreshWebcams();
 
 private:
@@ -37,6 +42,7 @@ private:
     void createMenuBar();
     void createStatusBar();
     void updateUIState(bool running);
+    void setRecording(bool enabled);
     
     VideoWidget *videoWidget;
     PTZPanel *ptzPanel;
@@ -44,20 +50,35 @@ private:
     
     QComboBox *webcamCombo;
     QComboBox *comPortCombo;
+    QComboBox *backendCombo;
+    QSpinBox *backendThreadsSpinBox;
+    QCheckBox *graphOptCheckbox;
+    QComboBox *resolutionCombo;
     QSpinBox *fpsSpinBox;
     QDoubleSpinBox *thresholdSpinBox;
+    QSpinBox *keyframeSpinBox;
+    QSpinBox *budgetSpinBox;
     QCheckBox *autoTrackCheckbox;
+    QCheckBox *autoZoomCheckbox;
+    QCheckBox *roiCheckbox;
+    QCheckBox *motionGateCheckbox;
+    QCheckBox *overlayCheckbox;
     
     QPushButton *startButton;
     QPushButton *stopButton;
     QLabel *fpsLabel;
     QLabel *statusLabel;
     QLabel *detectionLabel;
+    QLabel *latencyLabel;
     
     std::unique_ptr<CaptureEngine> captureEngine;
     std::unique_ptr<PTZController> ptzController;
+    std::shared_ptr<SessionRecorder> sessionRecorder;
+    QAction *recordAction;
     
     bool isRunning;
+    double ptzAckMs;        // Média móvel do RTT VISCA (ACK)
+    double ptzCompletionMs; // e da conclusão do comando
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "MotionGate.h"
+
+MotionGate::MotionGate()
+    : width(160), pixel_threshold(18), change_ratio(0.003f), bg_alpha(0.05f),
+      keepalive_s(2.0f), hold_frames(15), holdLeft(0), lastRatio(0)
+{
+}
+
+void MotionGate::reset() {
+    background.release();
+    holdLeft = 0;
+    lastRatio = 0;
+}
+
+bool MotionGate::shouldDetect(const cv::Mat& frame, bool trackActive, Clock::time_point now) {
+    // Reduz antes de converter: a conversão de cor roda em 1/16 dos pixels
+    int height = std::max(1, frame.rows * width / std::max(1, frame.cols));
+    cv::resize(frame, small, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+    cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+    gray.convertTo(grayF, CV_32F);
+
+    bool moved = true;
+    if (background.size() != grayF.size()) {
+        grayF.copyTo(background); // Primeiro frame (ou nova resolução): sem referência
+        lastRatio = 1.0f;
+    } else {
+        cv::absdiff(grayF, background, diff);
+        cv::compare(diff, (double)pixel_threshold, mask, cv::CMP_GT);
+        lastRatio = (float)cv::countNonZero(mask) / (float)mask.total();
+        moved = lastRatio >= change_ratio;
+        cv::accumulateWeighted(grayF, background, bg_alpha);
+    }
+
+    if (moved) holdLeft = hold_frames;
+    bool keepalive = std::chrono::duration<float>(now - lastDetect).count() >= keepalive_s;
+
+    if (trackActive || moved || holdLeft > 0 || keepalive) {
+        if (holdLeft > 0) holdLeft--;
+        lastDetect = now;
+        return true;
+    }
+    return false;
+}
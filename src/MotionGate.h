@@ -0,0 +1,39 @@
+#ifndef MOTIONGATE_H
+#define MOTIONGATE_H
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+
+// Detector de mudança barato na frente do YOLO: o frame reduzido em cinza
+// é comparado com um fundo de média móvel. Sem movimento e sem trilha
+// ativa a inferência é pulada; um keep-alive garante detecção periódica
+// (pessoa parada que entrou enquanto o fundo era aprendido, por exemplo).
+class MotionGate {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    MotionGate();
+
+    // true quando o frame precisa passar pelo detector. O fundo é
+    // atualizado em todos os frames, com ou sem detecção.
+    bool shouldDetect(const cv::Mat& frame, bool trackActive, Clock::time_point now);
+    void reset();
+    // Fração de pixels alterados no último frame
+    float changeRatio() const { return lastRatio; }
+
+    int width;             // largura do frame reduzido (px)
+    int pixel_threshold;   // diferença de cinza que conta como mudança
+    float change_ratio;    // fração de pixels alterados para acordar o detector
+    float bg_alpha;        // taxa de aprendizado do fundo
+    float keepalive_s;     // intervalo máximo sem detecção (s)
+    int hold_frames;       // frames detectados após o último movimento
+
+private:
+    cv::Mat small, gray, grayF, diff, mask;
+    cv::Mat background; // CV_32F
+    Clock::time_point lastDetect;
+    int holdLeft;
+    float lastRatio;
+};
+
+#endif
@@ -0,0 +1,186 @@
+#include "MultiObjectTracker.h"
+#include <algorithm>
+#include <tuple>
+
+namespace {
+
+// Ruídos relativos à altura da caixa (mesma ideia do ByteTrack)
+const float kPositionNoise = 1.0f / 20.0f;
+const float kVelocityNoise = 1.0f / 160.0f;
+
+cv::Rect2f toRect2f(const cv::Rect& r) {
+    return cv::Rect2f((float)r.x, (float)r.y, (float)r.width, (float)r.height);
+}
+
+}
+
+void MultiObjectTracker::AxisFilter::init(float value, float scale) {
+    p = value;
+    v = 0;
+    float sp = 2 * kPositionNoise * scale;
+    float sv = 10 * kVelocityNoise * scale;
+    P00 = sp * sp;
+    P01 = 0;
+    P11 = sv * sv;
+}
+
+void MultiObjectTracker::AxisFilter::predict(float q) {
+    // x = F x; P = F P F' + Q, com F = [1 1; 0 1]
+    p += v;
+    P00 += 2 * P01 + P11 + q;
+    P01 += P11;
+    P11 += q * 0.1f;
+}
+
+void MultiObjectTracker::AxisFilter::correct(float z, float r) {
+    float s = P00 + r;
+    float k0 = P00 / s;
+    float k1 = P01 / s;
+    float residual = z - p;
+    p += k0 * residual;
+    v += k1 * residual;
+    P11 -= k1 * P01;
+    P01 -= k0 * P01;
+    P00 -= k0 * P00;
+}
+
+cv::Rect2f MultiObjectTracker::Track::box() const {
+    return cv::Rect2f(cx.p - w.p / 2, cy.p - h.p / 2, std::max(1.0f, w.p), std::max(1.0f, h.p));
+}
+
+MultiObjectTracker::MultiObjectTracker()
+    : high_thresh(0.5f), low_thresh(0.1f), match_iou(0.3f), low_match_iou(0.5f),
+      min_hits(3), max_age(30), nextId(1)
+{
+}
+
+void MultiObjectTracker::reset() {
+    tracks.clear();
+    nextId = 1;
+}
+
+float MultiObjectTracker::iou(const cv::Rect2f& a, const cv::Rect2f& b) {
+    float inter = (a & b).area();
+    float uni = a.area() + b.area() - inter;
+    return uni > 0 ? inter / uni : 0.0f;
+}
+
+void MultiObjectTracker::predictTrack(Track& track) {
+    float scale = std::max(1.0f, track.h.p);
+    float qp = kPositionNoise * scale;
+    track.cx.predict(qp * qp);
+    track.cy.predict(qp * qp);
+    track.w.predict(qp * qp);
+    track.h.predict(qp * qp);
+    track.timeSinceUpdate++;
+}
+
+void MultiObjectTracker::correctTrack(Track& track, const Detection& det) {
+    float scale = std::max(1.0f, (float)det.bbox.height);
+    float r = kPositionNoise * scale;
+    track.cx.correct(det.bbox.x + det.bbox.width / 2.0f, r * r);
+    track.cy.correct(det.bbox.y + det.bbox.height / 2.0f, r * r);
+    track.w.correct((float)det.bbox.width, r * r);
+    track.h.correct((float)det.bbox.height, r * r);
+    track.hits++;
+    track.timeSinceUpdate = 0;
+    if (track.id < 0 && track.hits >= min_hits) {
+        track.id = nextId++;
+    }
+}
+
+void MultiObjectTracker::match(const std::vector<int>& trackIdx, const std::vector<Detection>& dets,
+                               const std::vector<int>& detIdx, float minIou,
+                               std::vector<std::pair<int, int>>& out) {
+    out.clear();
+    pairs.clear();
+    for (int t : trackIdx) {
+        cv::Rect2f predicted = tracks[t].box();
+        for (int d : detIdx) {
+            if (dets[d].classId != tracks[t].classId) continue;
+            float overlap = iou(predicted, toRect2f(dets[d].bbox));
+            if (overlap >= minIou) pairs.emplace_back(overlap, t, d);
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(),
+              [](const auto& a, const auto& b) { return std::get<0>(a) > std::get<0>(b); });
+    
+    std::vector<bool> trackUsed(tracks.size(), false);
+    std::vector<bool> detUsed(dets.size(), false);
+    for (const auto& [overlap, t, d] : pairs) {
+        if (trackUsed[t] || detUsed[d]) continue;
+        trackUsed[t] = true;
+        detUsed[d] = true;
+        out.emplace_back(t, d);
+    }
+}
+
+std::vector<Detection> MultiObjectTracker::update(const std::vector<Detection>& detections) {
+    for (auto& track : tracks) {
+        predictTrack(track);
+    }
+    
+    std::vector<int> high, low;
+    for (int i = 0; i < (int)detections.size(); i++) {
+        if (detections[i].confidence >= high_thresh) {
+            high.push_back(i);
+        } else if (detections[i].confidence >= low_thresh) {
+            low.push_back(i);
+        }
+    }
+    
+    std::vector<Detection> output;
+    output.reserve(detections.size());
+    std::vector<bool> trackMatched(tracks.size(), false);
+    std::vector<bool> detMatched(detections.size(), false);
+    
+    auto accept = [&](int t, int d) {
+        correctTrack(tracks[t], detections[d]);
+        trackMatched[t] = true;
+        detMatched[d] = true;
+        Detection det = detections[d];
+        det.trackId = tracks[t].id;
+        output.push_back(det);
+    };
+    
+    // 1ª etapa: alta confiança contra todas as trilhas
+    std::vector<int> allTracks(tracks.size());
+    for (int t = 0; t < (int)tracks.size(); t++) allTracks[t] = t;
+    match(allTracks, detections, high, match_iou, matches);
+    for (const auto& [t, d] : matches) accept(t, d);
+    
+    // 2ª etapa: baixa confiança (oclusão, blur) só recupera trilhas
+    // confirmadas que estavam ativas no frame anterior
+    std::vector<int> remaining;
+    for (int t = 0; t < (int)tracks.size(); t++) {
+        if (!trackMatched[t] && tracks[t].id >= 0 && tracks[t].timeSinceUpdate == 1) remaining.push_back(t);
+    }
+    match(remaining, detections, low, low_match_iou, matches);
+    for (const auto& [t, d] : matches) accept(t, d);
+    
+    // Trilhas expiradas saem; detecções fortes sem par abrem trilhas novas
+    tracks.erase(std::remove_if(tracks.begin(), tracks.end(),
+                 [this](const Track& t) { return t.timeSinceUpdate > max_age; }),
+                 tracks.end());
+    
+    for (int d : high) {
+        if (detMatched[d]) continue;
+        const Detection& det = detections[d];
+        Track track;
+        track.classId = det.classId;
+        float scale = std::max(1.0f, (float)det.bbox.height);
+        track.cx.init(det.bbox.x + det.bbox.width / 2.0f, scale);
+        track.cy.init(det.bbox.y + det.bbox.height / 2.0f, scale);
+        track.w.init((float)det.bbox.width, scale);
+        track.h.init((float)det.bbox.height, scale);
+        track.hits = 1;
+        if (track.hits >= min_hits) track.id = nextId++;
+        tracks.push_back(track);
+        
+        Detection out = det;
+        out.trackId = track.id;
+        output.push_back(out);
+    }
+    
+    return output;
+}
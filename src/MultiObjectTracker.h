@@ -0,0 +1,66 @@
+#ifndef MULTIOBJECTTRACKER_H
+#define MULTIOBJECTTRACKER_H
+
+#include <opencv2/opencv.hpp>
+#include <tuple>
+#include <vector>
+#include "YOLODetector.h"
+
+// Rastreador multi-objeto no estilo SORT/ByteTrack: Kalman de velocidade
+// constante por trilha + associação gulosa por IoU em duas etapas
+// (detecções de alta confiança primeiro, depois as de baixa). Preenche
+// Detection::trackId com IDs persistentes para trilhas confirmadas.
+class MultiObjectTracker {
+public:
+    MultiObjectTracker();
+    
+    // Um passo por frame processado; devolve as detecções associadas
+    std::vector<Detection> update(const std::vector<Detection>& detections);
+    void reset();
+    bool hasTracks() const { return !tracks.empty(); }
+    
+    float high_thresh;   // separa alta/baixa confiança (limiar do usuário)
+    float low_thresh;    // abaixo disto a detecção é ignorada (limiar do detector)
+    float match_iou;     // IoU mínimo na 1ª associação
+    float low_match_iou; // IoU mínimo na 2ª associação (baixa confiança)
+    int min_hits;        // associações até a trilha ganhar ID
+    int max_age;         // frames sem associação até a trilha ser removida
+
+private:
+    // Kalman 1D [posição, velocidade] por coordenada (cx, cy, w, h)
+    struct AxisFilter {
+        float p = 0, v = 0;
+        float P00 = 1, P01 = 0, P11 = 1;
+        
+        void init(float value, float scale);
+        void predict(float q);
+        void correct(float z, float r);
+    };
+    
+    struct Track {
+        int id = -1; // -1 enquanto tentativa
+        int classId = 0;
+        int hits = 0;
+        int timeSinceUpdate = 0;
+        AxisFilter cx, cy, w, h;
+        
+        cv::Rect2f box() const;
+    };
+    
+    void predictTrack(Track& track);
+    void correctTrack(Track& track, const Detection& det);
+    static float iou(const cv::Rect2f& a, const cv::Rect2f& b);
+    // Casamento guloso por IoU decrescente entre subconjuntos de trilhas e detecções
+    void match(const std::vector<int>& trackIdx, const std::vector<Detection>& dets,
+               const std::vector<int>& detIdx, float minIou,
+               std::vector<std::pair<int, int>>& matches);
+    
+    std::vector<Track> tracks;
+    int nextId;
+    
+    // Buffers reutilizados
+    std::vector<std::pair<int, int>> matches;
+    std::vector<std::tuple<float, int, int>> pairs;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include "OnnxRuntimeBackend.h"
+
+namespace {
+
+Ort::SessionOptions makeOptions(const BackendConfig& config) {
+    Ort::SessionOptions options;
+    if (config.threads > 0) {
+        options.SetIntraOpNumThreads(config.threads);
+    }
+    options.SetGraphOptimizationLevel(config.optimizeGraph
+        ? GraphOptimizationLevel::ORT_ENABLE_ALL
+        : GraphOptimizationLevel::ORT_DISABLE_ALL);
+    return options;
+}
+
+#ifdef _WIN32
+std::wstring toModelPath(const std::string& path) {
+    return std::wstring(path.begin(), path.end());
+}
+#else
+const std::string& toModelPath(const std::string& path) {
+    return path;
+}
+#endif
+
+}
+
+OnnxRuntimeBackend::OnnxRuntimeBackend(const std::string& modelPath, const BackendConfig& config)
+    : env(ORT_LOGGING_LEVEL_WARNING, "PTZTracker"),
+      session(env, toModelPath(modelPath).c_str(), makeOptions(config)),
+      memoryInfo(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault))
+{
+    Ort::AllocatorWithDefaultOptions allocator;
+    
+    for (size_t i = 0; i < session.GetInputCount(); i++) {
+        inputNames.push_back(session.GetInputNameAllocated(i, allocator).get());
+    }
+    for (size_t i = 0; i < session.GetOutputCount(); i++) {
+        outputNames.push_back(session.GetOutputNameAllocated(i, allocator).get());
+    }
+    for (const auto& n : inputNames) inputNamePtrs.push_back(n.c_str());
+    for (const auto& n : outputNames) outputNamePtrs.push_back(n.c_str());
+}
+
+void OnnxRuntimeBackend::forward(const cv::Mat& input, std::vector<cv::Mat>& outputs) {
+    inputShape.assign(input.size.p, input.size.p + input.dims);
+    
+    // Tensor de entrada aponta direto para o blob do detector
+    Ort::Value tensor = Ort::Value::CreateTensor<float>(
+        memoryInfo, const_cast<float*>(input.ptr<float>()), input.total(),
+        inputShape.data(), inputShape.size());
+    
+    results = session.Run(Ort::RunOptions{nullptr},
+                          inputNamePtrs.data(), &tensor, 1,
+                          outputNamePtrs.data(), outputNamePtrs.size());
+    
+    outputs.clear();
+    for (auto& value : results) {
+        auto shape = value.GetTensorTypeAndShapeInfo().GetShape();
+        std::vector<int> sizes(shape.begin(), shape.end());
+        outputs.emplace_back((int)sizes.size(), sizes.data(), CV_32F,
+                             value.GetTensorMutableData<float>());
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef ONNXRUNTIMEBACKEND_H
+#define ONNXRUNTIMEBACKEND_H
+
+#include "InferenceBackend.h"
+#include <onnxruntime_cxx_api.h>
+
+// ONNX Runtime com o execution provider de CPU
+class OnnxRuntimeBackend : public InferenceBackend {
+public:
+    OnnxRuntimeBackend(const std::string& modelPath, const BackendConfig& config);
+    
+    void forward(const cv::Mat& input, std::vector<cv::Mat>& outputs) override;
+    std::string name() const override { return "onnxruntime"; }
+
+private:
+    Ort::Env env;
+    Ort::Session session;
+    Ort::MemoryInfo memoryInfo;
+    
+    std::vector<std::string> inputNames, outputNames;
+    std::vector<const char*> inputNamePtrs, outputNamePtrs;
+    std::vector<int64_t> inputShape;
+    
+    // Mantém a memória das saídas viva até o próximo forward (sem cópia)
+    std::vector<Ort::Value> results;
+};
+
+#endif
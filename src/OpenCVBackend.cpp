@@ -0,0 +1,22 @@
+#include "OpenCVBackend.h"
+
+OpenCVBackend::OpenCVBackend(const std::string& modelPath, const BackendConfig& config) {
+    // Carrega modelo YOLO ONNX
+    net = cv::dnn::readNetFromONNX(modelPath);
+    net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    net.enableFusion(config.optimizeGraph);
+    
+    // O pool de threads do OpenCV é global ao processo: o limite vale
+    // também para FrameDecoder, MotionGate e qualquer cv::parallel_for_
+    if (config.threads > 0) {
+        cv::setNumThreads(config.threads);
+    }
+    
+    outputNames = net.getUnconnectedOutLayersNames();
+}
+
+void OpenCVBackend::forward(const cv::Mat& input, std::vector<cv::Mat>& outputs) {
+    net.setInput(input);
+    net.forward(outputs, outputNames);
+}
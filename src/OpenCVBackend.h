@@ -0,0 +1,20 @@
+#ifndef OPENCVBACKEND_H
+#define OPENCVBACKEND_H
+
+#include "InferenceBackend.h"
+#include <opencv2/dnn.hpp>
+
+// Backend padrão: OpenCV DNN na CPU
+class OpenCVBackend : public InferenceBackend {
+public:
+    OpenCVBackend(const std::string& modelPath, const BackendConfig& config);
+    
+    void forward(const cv::Mat& input, std::vector<cv::Mat>& outputs) override;
+    std::string name() const override { return "opencv"; }
+
+private:
+    cv::dnn::Net net;
+    std::vector<std::string> outputNames;
+};
+
+#endif
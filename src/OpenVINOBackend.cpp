@@ -0,0 +1,35 @@
+#include "OpenVINOBackend.h"
+
+OpenVINOBackend::OpenVINOBackend(const std::string& modelPath, const BackendConfig& config) {
+    ov::AnyMap properties;
+    properties[ov::hint::performance_mode.name()] = ov::hint::PerformanceMode::LATENCY;
+    if (config.threads > 0) {
+        properties[ov::inference_num_threads.name()] = config.threads;
+    }
+    // Sem otimização: mantém a precisão do modelo (FP32) em vez de BF16/FP16
+    if (!config.optimizeGraph) {
+        properties[ov::hint::inference_precision.name()] = ov::element::f32;
+    }
+    
+    compiled = core.compile_model(core.read_model(modelPath), "CPU", properties);
+    request = compiled.create_infer_request();
+}
+
+void OpenVINOBackend::forward(const cv::Mat& input, std::vector<cv::Mat>& outputs) {
+    ov::Shape shape(input.size.p, input.size.p + input.dims);
+    
+    // Tensor de entrada aponta direto para o blob do detector.
+    // Com batch/resolução diferentes o plugin remodela a entrada se o
+    // modelo tiver dimensões dinâmicas.
+    ov::Tensor tensor(ov::element::f32, shape, const_cast<float*>(input.ptr<float>()));
+    request.set_input_tensor(tensor);
+    request.infer();
+    
+    outputs.clear();
+    for (size_t i = 0; i < compiled.outputs().size(); i++) {
+        ov::Tensor out = request.get_output_tensor(i);
+        ov::Shape outShape = out.get_shape();
+        std::vector<int> sizes(outShape.begin(), outShape.end());
+        outputs.emplace_back((int)sizes.size(), sizes.data(), CV_32F, out.data<float>());
+    }
+}
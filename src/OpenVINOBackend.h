@@ -0,0 +1,21 @@
+#ifndef OPENVINOBACKEND_H
+#define OPENVINOBACKEND_H
+
+#include "InferenceBackend.h"
+#include <openvino/openvino.hpp>
+
+// OpenVINO Runtime no dispositivo CPU
+class OpenVINOBackend : public InferenceBackend {
+public:
+    OpenVINOBackend(const std::string& modelPath, const BackendConfig& config);
+    
+    void forward(const cv::Mat& input, std::vector<cv::Mat>& outputs) override;
+    std::string name() const override { return "openvino"; }
+
+private:
+    ov::Core core;
+    ov::CompiledModel compiled;
+    ov::InferRequest request;
+};
+
+#endif
@@ -1,30 +1,59 @@
 #include "PTZController.h"
-#include <QThread>
+#include "ViscaProtocol.h"
+#include "ViscaTransport.h"
+#include "SessionRecorder.h"
+#include "LogRing.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point since, Clock::time_point now) {
+    return std::chrono::duration<double, std::milli>(now - since).count();
+}
+
+}
 
 PTZController::PTZController(const std::string &port, int baudrate)
-    : connected(false), lastPanSpeed(0), lastTiltSpeed(0), lastZoomSpeed(0)
+    : ioThread(nullptr), connected(false), lastPanSpeed(0), lastTiltSpeed(0), lastZoomSpeed(0),
+      zoomTurn(false), stopping(false)
 {
-    serial = std::make_unique<QSerialPort>();
-    serial->setPortName(QString::fromStdString(port));
-    serial->setBaudRate(baudrate);
-    serial->setDataBits(QSerialPort::Data8);
-    serial->setParity(QSerialPort::NoParity);
-    serial->setStopBits(QSerialPort::OneStop);
-    serial->setFlowControl(QSerialPort::NoFlowControl);
-    
-    if (serial->open(QIODevice::ReadWrite)) {
+    // A porta é aberta e usada só pela thread de I/O; a GUI nunca bloqueia nela
+    auto opened = std::make_shared<std::promise<bool>>();
+    std::future<bool> openResult = opened->get_future();
+    QString portName = QString::fromStdString(port);
+    
+    ioThread = QThread::create([this, portName, baudrate, opened]() {
+        ioLoop(portName, baudrate, *opened);
+    });
+    ioThread->start();
+    
+    if (openResult.get()) {
         connected = true;
-        emit commandSent("PTZ conectado em " + QString::fromStdString(port));
+        LogRing::post(1, "PTZ conectado em " + portName);
     } else {
-        emit error("Falha ao abrir porta " + QString::fromStdString(port));
+        emit error("Falha ao abrir porta " + portName);
     }
 }
 
 PTZController::~PTZController() {
     stop();
-    if (serial && serial->isOpen()) {
-        serial->close();
+    
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
     }
+    queueCond.notify_all();
+    
+    ioThread->wait();
+    delete ioThread;
+}
+
+void PTZController::setRecorder(std::shared_ptr<SessionRecorder> recorder) {
+    std::lock_guard<std::mutex> lock(recorderMutex);
+    sessionRecorder = std::move(recorder);
 }
 
 void PTZController::panTilt(int pan, int tilt) {
@@ -35,23 +64,7 @@ void PTZController::panTilt(int pan, int tilt) {
     lastPanSpeed = pan;
     lastTiltSpeed = tilt;
     
-    unsigned char panSpd = std::min(std::abs(pan), 24);
-    unsigned char tiltSpd = std::min(std::abs(tilt), 20);
-    unsigned char panDir = (pan > 0) ? 0x02 : (pan < 0) ? 0x01 : 0x03;
-    unsigned char tiltDir = (tilt > 0) ? 0x01 : (tilt < 0) ? 0x02 : 0x03;
-    
-    QByteArray cmd;
-    cmd.append((char)0x81);
-    cmd.append((char)0x01);
-    cmd.append((char)0x06);
-    cmd.append((char)0x01);
-    cmd.append((char)panSpd);
-    cmd.append((char)tiltSpd);
-    cmd.append((char)panDir);
-    cmd.append((char)tiltDir);
-    cmd.append((char)0xFF);
-    
-    sendCommand(cmd);
+    enqueuePanTilt(Visca::panTiltDrive(pan, tilt));
 }
 
 void PTZController::zoom(int speed) {
@@ -60,38 +73,17 @@ void PTZController::zoom(int speed) {
     if (speed == lastZoomSpeed) return;
     lastZoomSpeed = speed;
     
-    QByteArray cmd;
-    cmd.append((char)0x81);
-    cmd.append((char)0x01);
-    cmd.append((char)0x04);
-    cmd.append((char)0x07);
-    
-    if (speed > 0) {
-        unsigned char spd = std::min(std::abs(speed), 7);
-        cmd.append((char)(0x20 + spd));
-    } else if (speed < 0) {
-        unsigned char spd = std::min(std::abs(speed), 7);
-        cmd.append((char)(0x30 + spd));
-    } else {
-        cmd.append((char)0x00);
-    }
-    
-    cmd.append((char)0xFF);
-    sendCommand(cmd);
+    enqueueZoom(Visca::zoomDrive(speed));
 }
 
 void PTZController::home() {
     if (!connected) return;
     
-    QByteArray cmd;
-    cmd.append((char)0x81);
-    cmd.append((char)0x01);
-    cmd.append((char)0x06);
-    cmd.append((char)0x04);
-    cmd.append((char)0xFF);
+    lastPanSpeed = 0;
+    lastTiltSpeed = 0;
     
-    sendCommand(cmd);
-    emit commandSent("Retornando para HOME");
+    enqueuePriority(Visca::home(), true);
+    LogRing::post(0, "Retornando para HOME");
 }
 
 void PTZController::stop() {
@@ -101,51 +93,227 @@ void PTZController::stop() {
     lastTiltSpeed = 0;
     lastZoomSpeed = 0;
     
-    QByteArray cmd;
-    cmd.append((char)0x81);
-    cmd.append((char)0x01);
-    cmd.append((char)0x06);
-    cmd.append((char)0x01);
-    cmd.append((char)0x00);
-    cmd.append((char)0x00);
-    cmd.append((char)0x03);
-    cmd.append((char)0x03);
-    cmd.append((char)0xFF);
-    
-    sendCommand(cmd);
+    enqueuePriority(Visca::stop(), true);
 }
 
 void PTZController::openMenu() {
     if (!connected) return;
     
-    QByteArray cmd;
-    cmd.append((char)0x81);
-    cmd.append((char)0x01);
-    cmd.append((char)0x06);
-    cmd.append((char)0x06);
-    cmd.append((char)0x02);
-    cmd.append((char)0xFF);
+    enqueuePriority(Visca::menu(), false);
+    LogRing::post(0, "Abrindo menu VISCA...");
+}
+
+void PTZController::enqueuePanTilt(const QByteArray &cmd) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pendingPanTilt = cmd; // Substitui o comando ainda não transmitido
+    }
+    queueCond.notify_one();
+}
+
+void PTZController::enqueueZoom(const QByteArray &cmd) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pendingZoom = cmd;
+    }
+    queueCond.notify_one();
+}
+
+void PTZController::enqueuePriority(const QByteArray &cmd, bool clearMotion) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        // Stop/home invalidam movimentos ainda não transmitidos
+        if (clearMotion) {
+            pendingPanTilt.reset();
+            pendingZoom.reset();
+        }
+        priorityQueue.push_back(cmd);
+    }
+    queueCond.notify_one();
+}
+
+void PTZController::requeue(const Outgoing &cmd) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    // Buffer cheio: reenvia, a menos que já exista um comando mais novo do eixo
+    switch (cmd.kind) {
+        case CommandKind::PanTilt:
+            if (!pendingPanTilt) pendingPanTilt = cmd.bytes;
+            break;
+        case CommandKind::Zoom:
+            if (!pendingZoom) pendingZoom = cmd.bytes;
+            break;
+        case CommandKind::Priority:
+            priorityQueue.push_front(cmd.bytes);
+            break;
+    }
+}
+
+bool PTZController::takeNextCommand(Outgoing &cmd, int waitMs) {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueCond.wait_for(lock, std::chrono::milliseconds(waitMs), [this]() {
+        return stopping || !priorityQueue.empty() || pendingPanTilt || pendingZoom;
+    });
+    
+    if (!priorityQueue.empty()) {
+        cmd.bytes = priorityQueue.front();
+        cmd.kind = CommandKind::Priority;
+        priorityQueue.pop_front();
+        return true;
+    }
+    if (stopping || (!pendingPanTilt && !pendingZoom)) {
+        return false; // Ao encerrar, só os comandos prioritários são enviados
+    }
     
-    sendCommand(cmd);
-    emit commandSent("Abrindo menu VISCA...");
+    // Alterna entre pan/tilt e zoom quando os dois estão pendentes
+    bool takeZoom = pendingZoom && (!pendingPanTilt || zoomTurn);
+    if (takeZoom) {
+        cmd.bytes = *pendingZoom;
+        cmd.kind = CommandKind::Zoom;
+        pendingZoom.reset();
+    } else {
+        cmd.bytes = *pendingPanTilt;
+        cmd.kind = CommandKind::PanTilt;
+        pendingPanTilt.reset();
+    }
+    zoomTurn = !takeZoom;
+    return true;
 }
 
-void PTZController::sendCommand(const QByteArray &cmd) {
-    if (serial && serial->isOpen()) {
-        serial->write(cmd);
-        serial->flush();
-        serial->waitForBytesWritten(100);
+bool PTZController::exitRequested() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return stopping && priorityQueue.empty();
+}
+
+void PTZController::ioLoop(const QString &port, int baudrate, std::promise<bool> &opened) {
+    std::unique_ptr<ViscaTransport> transport = ViscaTransport::create(port, baudrate);
+    bool ok = transport->open();
+    opened.set_value(ok);
+    if (!ok) return;
+    
+    // Controle de fluxo VISCA: um comando por vez aguardando ACK e no
+    // máximo kSockets em execução. O próximo sai assim que um socket libera.
+    Visca::ReplyParser parser;
+    std::optional<InFlight> awaitingAck;
+    std::optional<InFlight> sockets[kSockets + 1]; // índices 1..kSockets
+    bool blindMode = false;
+    int missedAcks = 0;
+    Clock::time_point nextSend = Clock::now();
+    
+    auto busySockets = [&]() {
+        int busy = 0;
+        for (int s = 1; s <= kSockets; s++) busy += sockets[s] ? 1 : 0;
+        return busy;
+    };
+    
+    auto handleReply = [&](const Visca::Reply &reply, Clock::time_point now) {
+        bool knownSocket = reply.socket >= 1 && reply.socket <= kSockets;
+        
+        if (reply.type == Visca::Reply::Ack) {
+            if (blindMode) {
+                blindMode = false;
+                LogRing::post(0, "Câmera respondeu ACK: controle de fluxo VISCA ativo");
+            }
+            missedAcks = 0;
+            if (awaitingAck) {
+                awaitingAck->ackMs = elapsedMs(awaitingAck->sent, now);
+                if (knownSocket) sockets[reply.socket] = awaitingAck;
+                awaitingAck.reset();
+            }
+        } else if (reply.type == Visca::Reply::Completion) {
+            if (knownSocket && sockets[reply.socket]) {
+                emit roundTripMeasured(sockets[reply.socket]->ackMs,
+                                       elapsedMs(sockets[reply.socket]->sent, now));
+                sockets[reply.socket].reset();
+            } else if (awaitingAck) {
+                // Alguns comandos são concluídos sem ACK separado
+                double ms = elapsedMs(awaitingAck->sent, now);
+                emit roundTripMeasured(ms, ms);
+                awaitingAck.reset();
+            }
+        } else {
+            std::optional<InFlight> failed;
+            if (knownSocket && sockets[reply.socket]) {
+                failed = sockets[reply.socket];
+                sockets[reply.socket].reset();
+            } else if (awaitingAck) {
+                failed = awaitingAck;
+                awaitingAck.reset();
+            }
+            
+            if (reply.errorCode == Visca::BufferFull && failed) {
+                requeue(failed->cmd);
+                nextSend = now + std::chrono::milliseconds(kBufferFullBackoffMs);
+            } else {
+                emit error(QString("VISCA: %1%2")
+                    .arg(Visca::errorText(reply.errorCode))
+                    .arg(failed ? " (" + Visca::toHex(failed->cmd.bytes) + ")" : QString()));
+            }
+        }
+    };
+    
+    while (!(exitRequested() && !awaitingAck)) {
+        Clock::time_point now = Clock::now();
         
-        QThread::msleep(40);
+        // Expira comandos sem resposta
+        if (awaitingAck && elapsedMs(awaitingAck->sent, now) > kAckTimeoutMs) {
+            awaitingAck.reset();
+            if (++missedAcks >= kMissedAcksForFallback && !blindMode) {
+                blindMode = true;
+                emit error(QString("Câmera não envia ACK VISCA; usando intervalo fixo de %1 ms")
+                    .arg(kBlindIntervalMs));
+            }
+        }
+        for (int s = 1; s <= kSockets; s++) {
+            if (sockets[s] && elapsedMs(sockets[s]->sent, now) > kCompletionTimeoutMs) {
+                sockets[s].reset();
+            }
+        }
         
-        emit commandSent(commandToString(cmd));
+        bool inFlight = awaitingAck || busySockets() > 0;
+        bool canSend = !awaitingAck && busySockets() < kSockets && now >= nextSend;
+        
+        Outgoing cmd;
+        if (canSend && takeNextCommand(cmd, inFlight ? 0 : 20)) {
+            if (!transport->send(cmd.bytes)) {
+                LogRing::post(2, "Falha ao enviar comando VISCA via " + transport->description());
+            }
+            if (LogRing::debugEnabled()) LogRing::post(4, "VISCA " + Visca::toHex(cmd.bytes));
+            {
+                std::lock_guard<std::mutex> lock(recorderMutex);
+                if (sessionRecorder) {
+                    sessionRecorder->recordVisca(SessionRecorder::now(), cmd.bytes);
+                }
+            }
+            
+            Clock::time_point sent = Clock::now();
+            if (blindMode) {
+                nextSend = sent + std::chrono::milliseconds(kBlindIntervalMs);
+            } else {
+                awaitingAck = InFlight{cmd, sent, 0.0};
+            }
+            continue;
+        }
+        
+        // Espera resposta (ou o fim do intervalo fixo) sem travar a fila
+        int waitMs = 2;
+        if (!canSend && !awaitingAck && now < nextSend) {
+            waitMs = std::max(1, (int)std::ceil(elapsedMs(now, nextSend)));
+        } else if (awaitingAck && !canSend) {
+            waitMs = std::max(1, kAckTimeoutMs - (int)elapsedMs(awaitingAck->sent, now));
+        } else if (!inFlight) {
+            waitMs = 0; // Já esperamos na fila; só coleta o que chegou
+        }
+        
+        QByteArray bytes;
+        if (transport->waitForReply(bytes, waitMs)) {
+            parser.feed(bytes);
+            Visca::Reply reply;
+            Clock::time_point received = Clock::now();
+            while (parser.next(reply)) {
+                handleReply(reply, received);
+            }
+        }
     }
+    
+    transport->close();
 }
-
-QString PTZController::commandToString(const QByteArray &cmd) {
-    QString hex;
-    for (unsigned char byte : cmd) {
-        hex += QString::number(byte, 16).toUpper().rightJustified(2, '0') + " ";
-    }
-    return hex.trimmed();
-}
\ No newline at end of file
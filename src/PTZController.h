@@ -2,8 +2,16 @@
 #define PTZCONTROLLER_H
 
 #include <QObject>
-#include <QSerialPort>
+#include <QThread>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <optional>
+
+class SessionRecorder;
 
 class PTZController : public QObject {
     Q_OBJECT
@@ -12,6 +20,9 @@ public:
     PTZController(const std::string &port, int baudrate);
     ~PTZController();
     
+    // Registra na sessão gravada cada comando efetivamente transmitido
+    void setRecorder(std::shared_ptr<SessionRecorder> recorder);
+    
 public slots:
     void panTilt(int pan, int tilt);
     void zoom(int speed);
@@ -20,18 +31,57 @@ public slots:
     void openMenu();
 
 signals:
-    void commandSent(const QString &cmd);
     void error(const QString &msg);
+    void roundTripMeasured(double ackMs, double completionMs);
 
 private:
-    void sendCommand(const QByteArray &cmd);
-    QString commandToString(const QByteArray &cmd);
+    enum class CommandKind { PanTilt, Zoom, Priority };
+    
+    struct Outgoing {
+        QByteArray bytes;
+        CommandKind kind = CommandKind::Priority;
+    };
+    
+    struct InFlight {
+        Outgoing cmd;
+        std::chrono::steady_clock::time_point sent;
+        double ackMs = 0.0;
+    };
     
-    std::unique_ptr<QSerialPort> serial;
+    // A câmera executa até 2 comandos simultâneos (sockets 1 e 2)
+    static constexpr int kSockets = 2;
+    static constexpr int kAckTimeoutMs = 200;
+    static constexpr int kCompletionTimeoutMs = 5000;
+    static constexpr int kMissedAcksForFallback = 3;
+    static constexpr int kBlindIntervalMs = 40; // câmeras que não respondem
+    static constexpr int kBufferFullBackoffMs = 10;
+    
+    // Os slots só enfileiram; a thread de I/O transmite pelo ViscaTransport
+    void enqueuePanTilt(const QByteArray &cmd);
+    void enqueueZoom(const QByteArray &cmd);
+    void enqueuePriority(const QByteArray &cmd, bool clearMotion);
+    void requeue(const Outgoing &cmd);
+    void ioLoop(const QString &port, int baudrate, std::promise<bool> &opened);
+    bool takeNextCommand(Outgoing &cmd, int waitMs);
+    bool exitRequested();
+    
+    QThread *ioThread;
     bool connected;
     int lastPanSpeed;
     int lastTiltSpeed;
     int lastZoomSpeed;
+    
+    // Slots latest-wins: só o comando mais novo de cada eixo é transmitido
+    std::mutex queueMutex;
+    std::condition_variable queueCond;
+    std::optional<QByteArray> pendingPanTilt;
+    std::optional<QByteArray> pendingZoom;
+    std::deque<QByteArray> priorityQueue; // stop/home/menu
+    bool zoomTurn;
+    bool stopping;
+    
+    std::mutex recorderMutex;
+    std::shared_ptr<SessionRecorder> sessionRecorder;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,33 @@
+#include "SerialTransport.h"
+
+SerialTransport::SerialTransport(const QString &port, int baudrate)
+    : port(port), baudrate(baudrate)
+{
+}
+
+bool SerialTransport::open() {
+    serial.setPortName(port);
+    serial.setBaudRate(baudrate);
+    serial.setDataBits(QSerialPort::Data8);
+    serial.setParity(QSerialPort::NoParity);
+    serial.setStopBits(QSerialPort::OneStop);
+    serial.setFlowControl(QSerialPort::NoFlowControl);
+    return serial.open(QIODevice::ReadWrite);
+}
+
+void SerialTransport::close() {
+    serial.close();
+}
+
+bool SerialTransport::send(const QByteArray &packet) {
+    if (serial.write(packet) != packet.size()) return false;
+    return serial.waitForBytesWritten(100);
+}
+
+bool SerialTransport::waitForReply(QByteArray &bytes, int timeoutMs) {
+    if (serial.bytesAvailable() == 0 && !serial.waitForReadyRead(timeoutMs)) {
+        return false;
+    }
+    bytes = serial.readAll();
+    return !bytes.isEmpty();
+}
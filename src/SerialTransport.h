@@ -0,0 +1,24 @@
+#ifndef SERIALTRANSPORT_H
+#define SERIALTRANSPORT_H
+
+#include "ViscaTransport.h"
+#include <QSerialPort>
+
+// VISCA em RS-232/RS-422 (8N1, sem controle de fluxo)
+class SerialTransport : public ViscaTransport {
+public:
+    SerialTransport(const QString &port, int baudrate);
+    
+    bool open() override;
+    void close() override;
+    bool send(const QByteArray &packet) override;
+    bool waitForReply(QByteArray &bytes, int timeoutMs) override;
+    QString description() const override { return port; }
+
+private:
+    QString port;
+    int baudrate;
+    QSerialPort serial;
+};
+
+#endif
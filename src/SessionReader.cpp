@@ -0,0 +1,191 @@
+#include "SessionReader.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+// Leitura sequencial little-endian com verificação de limites
+class PayloadReader {
+public:
+    PayloadReader(const char* data, uint32_t size) : p(data), end(data + size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (end - p < (ptrdiff_t)sizeof(T)) return false;
+        value = qFromLittleEndian<T>(p);
+        p += sizeof(T);
+        return true;
+    }
+
+    bool getFloat(float& value) {
+        uint32_t bits;
+        if (!get(bits)) return false;
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+
+    bool getFlag(bool& value) {
+        uint8_t byte;
+        if (!get(byte)) return false;
+        value = byte != 0;
+        return true;
+    }
+
+    const char* position() const { return p; }
+    size_t remaining() const { return (size_t)(end - p); }
+
+private:
+    const char* p;
+    const char* end;
+};
+
+}
+
+SessionReader::~SessionReader() {
+    close();
+}
+
+bool SessionReader::open(const QString& path) {
+    close();
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    length = file.size();
+    base = length >= Session::kFileHeaderSize ? file.map(0, length) : nullptr;
+    if (!base || std::memcmp(base, Session::kMagic, sizeof(Session::kMagic)) != 0 ||
+        qFromLittleEndian<uint32_t>(base + sizeof(Session::kMagic)) != Session::kVersion) {
+        close();
+        return false;
+    }
+
+    offset = Session::kFileHeaderSize;
+    truncatedTail = false;
+    return true;
+}
+
+void SessionReader::close() {
+    if (base) {
+        file.unmap(const_cast<uchar*>(base));
+        base = nullptr;
+    }
+    file.close();
+    length = 0;
+    offset = 0;
+}
+
+bool SessionReader::next(Chunk& chunk) {
+    if (!base || offset + Session::kChunkHeaderSize > length) {
+        truncatedTail = base && offset < length;
+        return false;
+    }
+
+    const uchar* header = base + offset;
+    uint32_t size = qFromLittleEndian<uint32_t>(header + 4);
+    qint64 padded = ((qint64)size + 7) / 8 * 8;
+    if (offset + Session::kChunkHeaderSize + size > length) {
+        truncatedTail = true; // Gravação interrompida no meio do chunk
+        return false;
+    }
+
+    uint64_t timeBits = qFromLittleEndian<uint64_t>(header + 8);
+    chunk.type = (Session::ChunkType)qFromLittleEndian<uint16_t>(header);
+    std::memcpy(&chunk.t, &timeBits, sizeof(chunk.t));
+    chunk.data = reinterpret_cast<const char*>(header + Session::kChunkHeaderSize);
+    chunk.size = size;
+    offset += Session::kChunkHeaderSize + padded;
+    return true;
+}
+
+bool SessionReader::parse(const Chunk& chunk, Session::FrameRecord& frame) {
+    if (chunk.type != Session::ChunkType::Frame) return false;
+
+    PayloadReader in(chunk.data, chunk.size);
+    int32_t encoding, width, height;
+    if (!in.get(frame.sequence) || !in.get(encoding) || !in.get(width) ||
+        !in.get(height) || !in.get(frame.bytes) || in.remaining() < frame.bytes) {
+        return false;
+    }
+    frame.encoding = (Session::FrameEncoding)encoding;
+    frame.size = cv::Size(width, height);
+    frame.data = in.position();
+    return true;
+}
+
+bool SessionReader::parse(const Chunk& chunk, Session::ObserveRecord& observe) {
+    if (chunk.type != Session::ChunkType::Observe) return false;
+
+    PayloadReader in(chunk.data, chunk.size);
+    int32_t width, height;
+    uint32_t count;
+    if (!in.get(width) || !in.get(height) || !in.get(count)) return false;
+    observe.frameSize = cv::Size(width, height);
+
+    observe.detections.clear();
+    for (uint32_t i = 0; i < count; i++) {
+        Detection det;
+        int32_t x, y, w, h, classId, trackId;
+        if (!in.get(x) || !in.get(y) || !in.get(w) || !in.get(h) ||
+            !in.getFloat(det.confidence) || !in.get(classId) || !in.get(trackId)) {
+            return false;
+        }
+        det.bbox = cv::Rect(x, y, w, h);
+        det.classId = classId;
+        det.trackId = trackId;
+        det.label = "Person";
+        observe.detections.push_back(det);
+    }
+    return true;
+}
+
+bool SessionReader::parse(const Chunk& chunk, Session::StepRecord& step) {
+    if (chunk.type != Session::ChunkType::Step) return false;
+
+    PayloadReader in(chunk.data, chunk.size);
+    int32_t pan, tilt, zoom;
+    if (!in.getFloat(step.dt) || !in.getFlag(step.autoTracking) ||
+        !in.getFlag(step.latencyCompensation) || !in.getFlag(step.autoZoom) ||
+        !in.getFlag(step.command.send) || !in.getFloat(step.actuationDelay) ||
+        !in.get(pan) || !in.get(tilt) || !in.get(zoom)) {
+        return false;
+    }
+    step.command.pan = pan;
+    step.command.tilt = tilt;
+    step.command.zoom = zoom;
+
+    ControllerState& s = step.state;
+    int32_t lostFrames, lockedId;
+    for (float* v : {&s.integral_x, &s.integral_y, &s.prev_err_x, &s.prev_err_y,
+                     &s.filtered_derivative_x, &s.filtered_derivative_y,
+                     &s.prev_ptz_speed_x, &s.prev_ptz_speed_y,
+                     &s.last_nx, &s.last_ny, &s.last_nz, &s.cam_gain_x, &s.cam_gain_y}) {
+        if (!in.getFloat(*v)) return false;
+    }
+    if (!in.get(lostFrames) || !in.get(lockedId) ||
+        !in.getFlag(s.target_valid) || !in.getFlag(s.manual_mode)) {
+        return false;
+    }
+    s.lost_frames = lostFrames;
+    s.locked_id = lockedId;
+    // Campo acrescentado depois: sessões antigas terminam antes dele
+    step.zoomFactor = 1;
+    if (in.remaining() >= sizeof(float) && !in.getFloat(step.zoomFactor)) return false;
+    return true;
+}
+
+bool SessionReader::parse(const Chunk& chunk, Session::ManualRecord& manual) {
+    if (chunk.type != Session::ChunkType::Manual) return false;
+
+    PayloadReader in(chunk.data, chunk.size);
+    return in.getFloat(manual.x) && in.getFloat(manual.y);
+}
+
+cv::Mat SessionReader::decodeFrame(const Session::FrameRecord& frame) {
+    if (frame.encoding == Session::FrameEncoding::JPEG) {
+        cv::Mat buffer(1, (int)frame.bytes, CV_8UC1, (void*)frame.data);
+        return cv::imdecode(buffer, cv::IMREAD_COLOR);
+    }
+    if (frame.bytes < (uint32_t)(frame.size.area() * 3)) return cv::Mat();
+    // Cópia: o mapeamento some no close()
+    return cv::Mat(frame.size.height, frame.size.width, CV_8UC3, (void*)frame.data).clone();
+}
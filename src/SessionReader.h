@@ -0,0 +1,45 @@
+#ifndef SESSIONREADER_H
+#define SESSIONREADER_H
+
+#include <QFile>
+#include <QString>
+#include "SessionRecorder.h"
+
+// Leitor de sessão gravada pelo SessionRecorder. O arquivo é mapeado em
+// memória (QFile::map) e percorrido chunk a chunk sem cópias; frames
+// apontam direto para o mapeamento.
+class SessionReader {
+public:
+    struct Chunk {
+        Session::ChunkType type;
+        double t = 0;
+        const char* data = nullptr;
+        uint32_t size = 0;
+    };
+
+    SessionReader() = default;
+    ~SessionReader();
+
+    bool open(const QString& path);
+    void close();
+    // Próximo chunk; false no fim do arquivo (ou no primeiro chunk truncado)
+    bool next(Chunk& chunk);
+    void rewind() { offset = Session::kFileHeaderSize; }
+    bool truncated() const { return truncatedTail; }
+
+    static bool parse(const Chunk& chunk, Session::FrameRecord& frame);
+    static bool parse(const Chunk& chunk, Session::ObserveRecord& observe);
+    static bool parse(const Chunk& chunk, Session::StepRecord& step);
+    static bool parse(const Chunk& chunk, Session::ManualRecord& manual);
+    // JPEG ou BGR bruto -> BGR
+    static cv::Mat decodeFrame(const Session::FrameRecord& frame);
+
+private:
+    QFile file;
+    const uchar* base = nullptr;
+    qint64 length = 0;
+    qint64 offset = 0;
+    bool truncatedTail = false;
+};
+
+#endif
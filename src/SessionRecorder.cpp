@@ -0,0 +1,253 @@
+#include "SessionRecorder.h"
+#include <QtEndian>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// Serialização little-endian (inteiros e floats pelo padrão de bits)
+template <typename T>
+void put(QByteArray& out, T value) {
+    T le = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char*>(&le), sizeof(le));
+}
+
+void putFloat(QByteArray& out, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put(out, bits);
+}
+
+void putDouble(QByteArray& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put(out, bits);
+}
+
+}
+
+SessionRecorder::SessionRecorder()
+    : jpeg_quality(80), frame_stride(1), max_backlog_bytes(64u << 20),
+      writer(nullptr), recording(false), backlogBytes(0), stopping(true), frameCounter(0),
+      written(0), dropped(0)
+{
+}
+
+SessionRecorder::~SessionRecorder() {
+    close();
+}
+
+double SessionRecorder::now() {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool SessionRecorder::open(const QString& path) {
+    close();
+
+    file = std::make_unique<QFile>(path);
+    if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.reset();
+        return false;
+    }
+
+    QByteArray header(Session::kMagic, sizeof(Session::kMagic));
+    put(header, Session::kVersion);
+    put(header, (uint32_t)0);
+    file->write(header);
+    written = header.size();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+        backlogBytes = 0;
+    }
+    frameCounter = 0;
+    dropped = 0;
+    writer = QThread::create([this]() { writeLoop(); });
+    writer->start();
+    recording = true;
+    return true;
+}
+
+void SessionRecorder::close() {
+    if (!writer) return;
+    recording = false;
+
+    // Esvazia a fila antes de sair: nada do que foi enfileirado se perde
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cond.notify_all();
+    writer->wait();
+    delete writer;
+    writer = nullptr;
+    file->close();
+    file.reset();
+}
+
+void SessionRecorder::enqueue(Pending item) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return;
+        size_t bytes = item.payload.size() + item.frame.total() * item.frame.elemSize();
+        if (!item.frame.empty() && backlogBytes + bytes > max_backlog_bytes) {
+            dropped++; // Disco lento: perde o frame, preserva a linha do tempo do controle
+            return;
+        }
+        backlogBytes += bytes;
+        queue.push_back(std::move(item));
+    }
+    cond.notify_one();
+}
+
+void SessionRecorder::recordFrame(double t, uint64_t sequence, const cv::Mat& frame) {
+    if (!recording || frame.empty()) return;
+    if (frame_stride > 1 && frameCounter++ % frame_stride != 0) return;
+
+    Pending item;
+    item.type = Session::ChunkType::Frame;
+    item.t = t;
+    item.sequence = sequence;
+    item.frame = frame; // Frames não mudam depois da captura: basta a referência
+    enqueue(std::move(item));
+}
+
+void SessionRecorder::recordObserve(double t, const cv::Size& frameSize,
+                                    const std::vector<Detection>& detections) {
+    if (!recording) return;
+
+    Pending item;
+    item.type = Session::ChunkType::Observe;
+    item.t = t;
+    put(item.payload, (int32_t)frameSize.width);
+    put(item.payload, (int32_t)frameSize.height);
+    put(item.payload, (uint32_t)detections.size());
+    for (const auto& det : detections) {
+        put(item.payload, (int32_t)det.bbox.x);
+        put(item.payload, (int32_t)det.bbox.y);
+        put(item.payload, (int32_t)det.bbox.width);
+        put(item.payload, (int32_t)det.bbox.height);
+        putFloat(item.payload, det.confidence);
+        put(item.payload, (int32_t)det.classId);
+        put(item.payload, (int32_t)det.trackId);
+    }
+    enqueue(std::move(item));
+}
+
+void SessionRecorder::recordStep(double t, const Session::StepRecord& step) {
+    if (!recording) return;
+
+    Pending item;
+    item.type = Session::ChunkType::Step;
+    item.t = t;
+    QByteArray& p = item.payload;
+    putFloat(p, step.dt);
+    put(p, (uint8_t)step.autoTracking);
+    put(p, (uint8_t)step.latencyCompensation);
+    put(p, (uint8_t)step.autoZoom);
+    put(p, (uint8_t)step.command.send);
+    putFloat(p, step.actuationDelay);
+    put(p, (int32_t)step.command.pan);
+    put(p, (int32_t)step.command.tilt);
+    put(p, (int32_t)step.command.zoom);
+
+    const ControllerState& s = step.state;
+    for (float v : {s.integral_x, s.integral_y, s.prev_err_x, s.prev_err_y,
+                    s.filtered_derivative_x, s.filtered_derivative_y,
+                    s.prev_ptz_speed_x, s.prev_ptz_speed_y,
+                    s.last_nx, s.last_ny, s.last_nz, s.cam_gain_x, s.cam_gain_y}) {
+        putFloat(p, v);
+    }
+    put(p, (int32_t)s.lost_frames);
+    put(p, (int32_t)s.locked_id);
+    put(p, (uint8_t)s.target_valid);
+    put(p, (uint8_t)s.manual_mode);
+    putFloat(p, step.zoomFactor);
+    enqueue(std::move(item));
+}
+
+void SessionRecorder::recordManual(double t, float x, float y) {
+    if (!recording) return;
+
+    Pending item;
+    item.type = Session::ChunkType::Manual;
+    item.t = t;
+    putFloat(item.payload, x);
+    putFloat(item.payload, y);
+    enqueue(std::move(item));
+}
+
+void SessionRecorder::recordReset(double t) {
+    if (!recording) return;
+
+    Pending item;
+    item.type = Session::ChunkType::Reset;
+    item.t = t;
+    enqueue(std::move(item));
+}
+
+void SessionRecorder::recordVisca(double t, const QByteArray& bytes) {
+    if (!recording) return;
+
+    Pending item;
+    item.type = Session::ChunkType::Visca;
+    item.t = t;
+    item.payload = bytes;
+    enqueue(std::move(item));
+}
+
+QByteArray SessionRecorder::encodeFrame(const Pending& item) const {
+    QByteArray payload;
+    std::vector<uchar> jpeg;
+    bool compressed = jpeg_quality > 0 &&
+        cv::imencode(".jpg", item.frame, jpeg, {cv::IMWRITE_JPEG_QUALITY, jpeg_quality});
+
+    put(payload, item.sequence);
+    put(payload, (int32_t)(compressed ? Session::FrameEncoding::JPEG : Session::FrameEncoding::BGR));
+    put(payload, (int32_t)item.frame.cols);
+    put(payload, (int32_t)item.frame.rows);
+    if (compressed) {
+        put(payload, (uint32_t)jpeg.size());
+        payload.append(reinterpret_cast<const char*>(jpeg.data()), (int)jpeg.size());
+    } else {
+        cv::Mat bgr = item.frame.isContinuous() ? item.frame : item.frame.clone();
+        uint32_t bytes = (uint32_t)(bgr.total() * bgr.elemSize());
+        put(payload, bytes);
+        payload.append(reinterpret_cast<const char*>(bgr.data), (int)bytes);
+    }
+    return payload;
+}
+
+void SessionRecorder::writeLoop() {
+    static const char zeros[8] = {};
+
+    while (true) {
+        Pending item;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) break; // stopping e fila vazia
+            item = std::move(queue.front());
+            queue.pop_front();
+            backlogBytes -= item.payload.size() + item.frame.total() * item.frame.elemSize();
+        }
+
+        const QByteArray payload = item.type == Session::ChunkType::Frame
+            ? encodeFrame(item) : item.payload;
+
+        QByteArray header;
+        put(header, (uint16_t)item.type);
+        put(header, (uint16_t)0);
+        put(header, (uint32_t)payload.size());
+        putDouble(header, item.t);
+
+        int padding = (8 - payload.size() % 8) % 8;
+        file->write(header);
+        file->write(payload);
+        file->write(zeros, padding);
+        written += header.size() + payload.size() + padding;
+    }
+    file->flush();
+}
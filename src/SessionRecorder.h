@@ -0,0 +1,131 @@
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QThread>
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "YOLODetector.h"
+#include "TrackingController.h"
+
+// Formato da sessão gravada: cabeçalho "PTZSESS" + versão, depois uma
+// sequência só de acréscimo de chunks
+//   u16 tipo | u16 reservado | u32 tamanho do payload | f64 tempo (s)
+//   payload little-endian, completado com zeros até múltiplo de 8
+// Um arquivo truncado (queda de energia) continua legível até o último
+// chunk completo, e o alinhamento permite ler direto do QFile::map.
+namespace Session {
+
+constexpr char kMagic[8] = {'P', 'T', 'Z', 'S', 'E', 'S', 'S', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr int kFileHeaderSize = 16;
+constexpr int kChunkHeaderSize = 16;
+
+enum class ChunkType : uint16_t {
+    Frame = 1,    // frame capturado (JPEG ou BGR bruto)
+    Observe = 2,  // detecções entregues ao TrackingController::observe
+    Step = 3,     // um passo do controle: entradas, comando e estado interno
+    Manual = 4,   // alvo manual (clique no vídeo)
+    Reset = 5,    // TrackingController::reset()
+    Visca = 6,    // bytes VISCA enviados à câmera
+};
+
+enum class FrameEncoding : int32_t { BGR = 0, JPEG = 1 };
+
+struct FrameRecord {
+    uint64_t sequence = 0;
+    FrameEncoding encoding = FrameEncoding::JPEG;
+    cv::Size size;
+    const char* data = nullptr; // aponta para o arquivo mapeado
+    uint32_t bytes = 0;
+};
+
+struct ObserveRecord {
+    cv::Size frameSize;
+    std::vector<Detection> detections;
+};
+
+struct StepRecord {
+    // Entradas do passo
+    float dt = 0;
+    bool autoTracking = false;
+    bool latencyCompensation = false;
+    bool autoZoom = false;
+    float actuationDelay = 0;
+    float zoomFactor = 1; // gravado no fim do payload (sessões antigas: 1)
+    // Saídas
+    PTZCommand command;
+    ControllerState state;
+};
+
+struct ManualRecord {
+    float x = 0, y = 0;
+};
+
+}
+
+// Gravador de sessão: os chamadores só enfileiram; a codificação JPEG e a
+// escrita em disco rodam numa thread própria. Frames são descartados
+// quando a fila passa de max_backlog_bytes; registros de controle nunca.
+class SessionRecorder {
+public:
+    SessionRecorder();
+    ~SessionRecorder();
+
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return recording; }
+
+    // t em segundos no relógio steady (mesma base do TrackingController)
+    void recordFrame(double t, uint64_t sequence, const cv::Mat& frame);
+    void recordObserve(double t, const cv::Size& frameSize, const std::vector<Detection>& detections);
+    void recordStep(double t, const Session::StepRecord& step);
+    void recordManual(double t, float x, float y);
+    void recordReset(double t);
+    void recordVisca(double t, const QByteArray& bytes);
+
+    // Segundos no relógio steady, para quem não tem o timestamp à mão
+    static double now();
+
+    uint64_t bytesWritten() const { return written; }
+    uint64_t droppedFrames() const { return dropped; }
+
+    int jpeg_quality;         // 0 = frames em BGR bruto
+    int frame_stride;         // grava 1 a cada N frames
+    size_t max_backlog_bytes; // limite da fila de escrita
+
+private:
+    struct Pending {
+        Session::ChunkType type;
+        double t;
+        QByteArray payload;
+        cv::Mat frame;       // Frame: codificado na thread de escrita
+        uint64_t sequence = 0;
+    };
+
+    void enqueue(Pending item);
+    void writeLoop();
+    QByteArray encodeFrame(const Pending& item) const;
+
+    std::unique_ptr<QFile> file;
+    QThread* writer;
+    std::atomic<bool> recording; // lido pelas threads que gravam
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<Pending> queue;
+    size_t backlogBytes;
+    bool stopping;
+    uint64_t frameCounter;
+    std::atomic<uint64_t> written;
+    std::atomic<uint64_t> dropped;
+};
+
+#endif
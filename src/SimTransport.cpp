@@ -0,0 +1,27 @@
+#include "SimTransport.h"
+#include <QThread>
+
+bool SimTransport::open() {
+    camera = VirtualPTZCamera::active();
+    return camera != nullptr;
+}
+
+void SimTransport::close() {
+    camera.reset();
+}
+
+bool SimTransport::send(const QByteArray &packet) {
+    if (!camera) return false;
+    replies.append(camera->handleCommand(packet));
+    return true;
+}
+
+bool SimTransport::waitForReply(QByteArray &bytes, int timeoutMs) {
+    if (replies.isEmpty()) {
+        QThread::msleep(timeoutMs); // Nada pendente: só espera, como a serial
+        return false;
+    }
+    bytes = replies;
+    replies.clear();
+    return true;
+}
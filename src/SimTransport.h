@@ -0,0 +1,22 @@
+#ifndef SIMTRANSPORT_H
+#define SIMTRANSPORT_H
+
+#include "ViscaTransport.h"
+#include "VirtualPTZCamera.h"
+#include <memory>
+
+// Porta "sim": entrega os comandos à VirtualPTZCamera ativa
+class SimTransport : public ViscaTransport {
+public:
+    bool open() override;
+    void close() override;
+    bool send(const QByteArray &packet) override;
+    bool waitForReply(QByteArray &bytes, int timeoutMs) override;
+    QString description() const override { return "sim"; }
+
+private:
+    std::shared_ptr<VirtualPTZCamera> camera;
+    QByteArray replies;
+};
+
+#endif
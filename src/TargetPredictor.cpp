@@ -0,0 +1,46 @@
+#include "TargetPredictor.h"
+#include <algorithm>
+
+TargetPredictor::TargetPredictor()
+    : alpha(0.6f), beta(0.15f), max_horizon(0.3f), max_gap(0.5f),
+      valid(false), last_t(0), x(0.5f), y(0.5f), vx(0), vy(0)
+{
+}
+
+void TargetPredictor::reset() {
+    valid = false;
+    vx = vy = 0;
+}
+
+void TargetPredictor::observe(double t, double nx, double ny) {
+    double dt = t - last_t;
+    if (!valid || dt <= 0.0 || dt > max_gap) {
+        valid = true;
+        last_t = t;
+        x = nx;
+        y = ny;
+        vx = vy = 0;
+        return;
+    }
+    
+    // Predição + correção pelo resíduo
+    double px = x + vx * dt;
+    double py = y + vy * dt;
+    double rx = nx - px;
+    double ry = ny - py;
+    
+    x = px + alpha * rx;
+    y = py + alpha * ry;
+    vx += beta * rx / dt;
+    vy += beta * ry / dt;
+    last_t = t;
+}
+
+bool TargetPredictor::predict(double t, double& nx, double& ny) const {
+    if (!valid) return false;
+    
+    double dt = std::clamp(t - last_t, 0.0, (double)max_horizon);
+    nx = x + vx * dt;
+    ny = y + vy * dt;
+    return true;
+}
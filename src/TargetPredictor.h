@@ -0,0 +1,32 @@
+#ifndef TARGETPREDICTOR_H
+#define TARGETPREDICTOR_H
+
+// Filtro alfa-beta (velocidade constante) sobre a posição normalizada do
+// alvo. Recebe observações com o timestamp de captura e extrapola a
+// posição entre elas para o laço de controle em taxa fixa. A posição não é
+// limitada a [0, 1]: fora do modo por frame ela está em coordenadas de mundo.
+class TargetPredictor {
+public:
+    TargetPredictor();
+    
+    void reset();
+    void observe(double t, double nx, double ny);
+    // Posição prevista em t; false enquanto não houver observação
+    bool predict(double t, double& nx, double& ny) const;
+    bool isValid() const { return valid; }
+    double lastTime() const { return last_t; }
+    // Velocidade estimada (unidades normalizadas por segundo)
+    void velocity(double& outVx, double& outVy) const { outVx = vx; outVy = vy; }
+    
+    float alpha, beta;
+    float max_horizon;  // extrapolação máxima além da última observação (s)
+    float max_gap;      // intervalo acima do qual o filtro reinicia (s)
+
+private:
+    bool valid;
+    double last_t;
+    double x, y;   // double: com compensação de câmera as coordenadas acumulam
+    double vx, vy; // por segundo
+};
+
+#endif
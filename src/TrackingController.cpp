@@ -0,0 +1,466 @@
+#include "TrackingController.h"
+#include <algorithm>
+#include <cmath>
+
+TrackingController::TrackingController()
+    : integral_x(0), integral_y(0), prev_err_x(0), prev_err_y(0),
+      filtered_derivative_x(0), filtered_derivative_y(0),
+      prev_ptz_speed_x(0), prev_ptz_speed_y(0),
+      last_nx(0.5), last_ny(0.5), last_nz(0),
+      lost_frames(0), target_valid(false), locked_id(-1),
+      last_shift_x(0), last_shift_y(0), compensated_delay(0), zoom_dir(0), stable_since(-1),
+      update_time(0), manual_mode(false),
+      manual_target_x(0.5), manual_target_y(0.5)
+{
+    // Parâmetros de controle
+    conf_min = 0.5f;
+    nz_min = 0.02f;
+    deadband = 0.03f;
+    
+    Kp_x = 1.2f; Ki_x = 0.05f; Kd_x = 0.06f;
+    Kp_y = 1.0f; Ki_y = 0.05f; Kd_y = 0.05f;
+    I_max = 0.5f;
+    
+    gamma = 0.8f;
+    near_edge_threshold = 0.15f;
+    approach_limit = 0.05f;
+    v_thresh = 0.02f;
+    slew_rate = 0.6f;
+    lpf_tau = 0.08f;
+    stop_threshold = 0.02f;
+    lost_max_frames = 15;
+    
+    latency_compensation = true;
+    actuation_delay = 0.05f;
+    // ~10°/s por 6 unidades de velocidade num FOV de 60°
+    cam_gain_x = 0.03f;
+    cam_gain_y = 0.04f;
+    gain_adapt_rate = 0.0f; // opt-in: aceleração do alvo contamina a estimativa
+    zoom_factor = 1.0f;     // informado por quem conhece o zoom (CaptureEngine, simulação)
+    
+    auto_zoom = false;
+    zoom_target = 0.2f; // pessoa de corpo inteiro ocupando ~1/2 da altura
+    zoom_band = 0.25f;
+    zoom_fast_motion = 0.4f;
+    zoom_settle_time = 0.8f;
+    zoom_speed_max = 3;
+}
+
+void TrackingController::setManualTarget(float x, float y) {
+    reset();
+    manual_mode = true;
+    manual_target_x = x;
+    manual_target_y = y;
+}
+
+void TrackingController::reset() {
+    integral_x = 0;
+    integral_y = 0;
+    prev_err_x = 0;
+    prev_err_y = 0;
+    filtered_derivative_x = 0;
+    filtered_derivative_y = 0;
+    prev_ptz_speed_x = 0;
+    prev_ptz_speed_y = 0;
+    last_nx = 0.5f;
+    last_ny = 0.5f;
+    last_nz = 0;
+    lost_frames = 0;
+    target_valid = false;
+    locked_id = -1;
+    last_shift_x = 0;
+    last_shift_y = 0;
+    compensated_delay = 0;
+    zoom_dir = 0;
+    stable_since = -1;
+    manual_mode = false;
+    predictor.reset();
+    cameraMotion.reset();
+}
+
+ControllerState TrackingController::state() const {
+    ControllerState s;
+    s.integral_x = integral_x;
+    s.integral_y = integral_y;
+    s.prev_err_x = prev_err_x;
+    s.prev_err_y = prev_err_y;
+    s.filtered_derivative_x = filtered_derivative_x;
+    s.filtered_derivative_y = filtered_derivative_y;
+    s.prev_ptz_speed_x = prev_ptz_speed_x;
+    s.prev_ptz_speed_y = prev_ptz_speed_y;
+    s.last_nx = last_nx;
+    s.last_ny = last_ny;
+    s.last_nz = last_nz;
+    s.cam_gain_x = cam_gain_x;
+    s.cam_gain_y = cam_gain_y;
+    s.lost_frames = lost_frames;
+    s.locked_id = locked_id;
+    s.target_valid = target_valid;
+    s.manual_mode = manual_mode;
+    return s;
+}
+
+bool TrackingController::targetHint(float& nx, float& ny, float& nz) const {
+    nx = last_nx;
+    ny = last_ny;
+    nz = last_nz;
+    return target_valid;
+}
+
+PTZCommand TrackingController::update(const cv::Size& frame,
+                                      const std::vector<Detection>& detections,
+                                      float dt, bool autoTracking) {
+    update_time += dt;
+    observe(frame, detections, update_time);
+    return step(update_time, dt, autoTracking);
+}
+
+void TrackingController::observe(const cv::Size& frame,
+                                 const std::vector<Detection>& detections,
+                                 double timestamp) {
+    // Modo manual: o alvo é a coordenada do clique
+    if (manual_mode) return;
+    
+    Detection bestTarget;
+    if (findTarget(frame, detections, bestTarget)) {
+        // A trilha travada já passou pelo limiar do MultiObjectTracker: uma
+        // caixa fraca dela é recuperação (oclusão, blur), não alvo novo
+        bool lockedTrack = bestTarget.trackId >= 0 && bestTarget.trackId == locked_id;
+        if (lockedTrack || bestTarget.confidence >= conf_min) {
+            // Normalizar bbox
+            float cx = bestTarget.bbox.x + bestTarget.bbox.width / 2.0f;
+            float cy = bestTarget.bbox.y + bestTarget.bbox.height / 2.0f;
+            float diag = std::sqrt(frame.width * frame.width + frame.height * frame.height);
+            
+            float nx = cx / frame.width;
+            float ny = cy / frame.height;
+            float nz = std::sqrt(bestTarget.bbox.width * bestTarget.bbox.height) / diag;
+            
+            if (nz >= nz_min) {
+                last_nx = nx;
+                last_ny = ny;
+                last_nz = nz;
+                lost_frames = 0;
+                target_valid = true;
+                
+                // Posição em coordenadas de mundo: soma o quanto a câmera já
+                // girou até o instante da captura
+                double sx = 0, sy = 0;
+                if (latency_compensation) {
+                    cameraMotion.shiftAt(timestamp, sx, sy);
+                    adaptCameraGain(timestamp, nx, ny, sx, sy);
+                }
+                predictor.observe(timestamp, nx + gainX() * sx, ny + gainY() * sy);
+                last_shift_x = sx;
+                last_shift_y = sy;
+                return;
+            }
+        }
+    }
+    
+    lost_frames++;
+    if (lost_frames < lost_max_frames) {
+        // Manter último comando com decaimento
+        integral_x *= 0.95f;
+        integral_y *= 0.95f;
+    } else {
+        // Alvo perdido: libera a trava para escolher outro
+        target_valid = false;
+        locked_id = -1;
+        predictor.reset();
+    }
+}
+
+bool TrackingController::findTarget(const cv::Size& frame,
+                                    const std::vector<Detection>& detections,
+                                    Detection& target) {
+    // Com IDs do MultiObjectTracker, segue a trilha travada; só reavalia
+    // o score quando a trava é perdida
+    std::vector<Detection> tracked;
+    for (const auto& det : detections) {
+        if (det.trackId < 0) continue;
+        if (det.trackId == locked_id) {
+            target = det;
+            return true;
+        }
+        tracked.push_back(det);
+    }
+    
+    if (tracked.empty()) {
+        // Sem rastreador: seleção por frame
+        if (detections.empty() || locked_id >= 0) return false;
+        target = selectBestTarget(frame, detections);
+        return true;
+    }
+    if (locked_id >= 0) return false; // Trilha travada sumiu: espera lost_max_frames
+    
+    target = selectBestTarget(frame, tracked);
+    if (target.confidence >= conf_min) {
+        locked_id = target.trackId;
+    }
+    return true;
+}
+
+PTZCommand TrackingController::step(double now, float dt, bool autoTracking) {
+    PTZCommand cmd = computeCommand(now, dt, autoTracking);
+    
+    // O comando só move a câmera depois do atraso de atuação
+    if (cmd.send && latency_compensation) {
+        cameraMotion.command(now + actuation_delay, (float)cmd.pan, (float)-cmd.tilt);
+    }
+    return cmd;
+}
+
+void TrackingController::adaptCameraGain(double t, double nx, double ny, double sx, double sy) {
+    // LMS normalizado: o resíduo da predição que acompanha o giro da
+    // câmera desde a observação anterior indica erro no ganho
+    double wx, wy;
+    if (!predictor.predict(t, wx, wy)) return;
+    
+    double dsx = sx - last_shift_x;
+    double dsy = sy - last_shift_y;
+    double predX = wx - gainX() * sx;
+    double predY = wy - gainY() * sy;
+    
+    // O ganho aprendido fica na escala de 1x: o giro vale zoom_factor vezes mais
+    const double minShift = 0.5; // velocidade·s mínima para o ajuste ser informativo
+    if (std::abs(dsx) > minShift) {
+        double step = gain_adapt_rate * (nx - predX) * dsx / (dsx * dsx * zoom_factor);
+        cam_gain_x = std::clamp((float)(cam_gain_x - step), 0.002f, 0.2f);
+    }
+    if (std::abs(dsy) > minShift) {
+        double step = gain_adapt_rate * (ny - predY) * dsy / (dsy * dsy * zoom_factor);
+        cam_gain_y = std::clamp((float)(cam_gain_y - step), 0.002f, 0.2f);
+    }
+}
+
+PTZCommand TrackingController::computeCommand(double now, float dt, bool autoTracking) {
+    PTZCommand cmd;
+    float nx, ny;
+    
+    if (manual_mode) {
+        nx = manual_target_x;
+        ny = manual_target_y;
+    } else {
+        // Prevê o alvo para quando o comando chegar ao motor e converte de
+        // volta para a imagem com o giro previsto da câmera até lá
+        double t = latency_compensation ? now + actuation_delay : now;
+        double wx, wy, sx = 0, sy = 0;
+        if (!target_valid || !predictor.predict(t, wx, wy)) {
+            // Alvo perdido - parar; o zoom abre para reencontrá-lo
+            if (autoTracking) {
+                cmd.send = true;
+                cmd.zoom = auto_zoom && !target_valid ? -zoom_speed_max : 0;
+            }
+            zoom_dir = 0;
+            stable_since = -1;
+            return cmd;
+        }
+        if (latency_compensation) {
+            cameraMotion.shiftAt(t, sx, sy);
+        }
+        nx = (float)std::clamp(wx - gainX() * sx, 0.0, 1.0);
+        ny = (float)std::clamp(wy - gainY() * sy, 0.0, 1.0);
+        compensated_delay = t - predictor.lastTime();
+    }
+    
+    // Calcular erro normalizado
+    float err_x = nx - 0.5f;
+    float err_y = ny - 0.5f;
+    float err_mag = std::sqrt(err_x * err_x + err_y * err_y);
+    
+    // Modo manual: parar quando próximo do alvo
+    if (manual_mode && err_mag < stop_threshold) {
+        manual_mode = false;
+        cmd.send = true;
+        return cmd;
+    }
+    
+    // Aplicar deadband
+    float err_x_eff = applyDeadband(err_x);
+    float err_y_eff = applyDeadband(err_y);
+    
+    // Calcular distâncias às bordas
+    float dist_x_edge = std::min(nx, 1.0f - nx);
+    float dist_y_edge = std::min(ny, 1.0f - ny);
+    
+    // Estimar velocidade do alvo
+    float v_target_x = (err_x - prev_err_x) / (dt + 1e-6f);
+    float v_target_y = (err_y - prev_err_y) / (dt + 1e-6f);
+    
+    // Calcular PID para X
+    float u_p_x = Kp_x * err_x_eff;
+    integral_x += Ki_x * err_x_eff * dt;
+    integral_x = std::clamp(integral_x, -I_max, I_max);
+    
+    float derivative_x = (err_x_eff - prev_err_x) / (dt + 1e-6f);
+    float alpha_d = std::exp(-dt / lpf_tau);
+    filtered_derivative_x = alpha_d * filtered_derivative_x + (1 - alpha_d) * derivative_x;
+    float u_d_x = Kd_x * filtered_derivative_x;
+    
+    float raw_speed_x = u_p_x + integral_x + u_d_x;
+    
+    // Calcular PID para Y
+    float u_p_y = Kp_y * err_y_eff;
+    integral_y += Ki_y * err_y_eff * dt;
+    integral_y = std::clamp(integral_y, -I_max, I_max);
+    
+    float derivative_y = (err_y_eff - prev_err_y) / (dt + 1e-6f);
+    filtered_derivative_y = alpha_d * filtered_derivative_y + (1 - alpha_d) * derivative_y;
+    float u_d_y = Kd_y * filtered_derivative_y;
+    
+    float raw_speed_y = u_p_y + integral_y + u_d_y;
+    
+    // Aplicar não-linearidade (suavização)
+    float speed_factor_x = applyNonLinearity(raw_speed_x);
+    float speed_factor_y = applyNonLinearity(raw_speed_y);
+    
+    // Mapear para range PTZ [1, 2]
+    float ptz_speed_x_target = 1.0f + speed_factor_x * 1.0f;
+    float ptz_speed_y_target = 1.0f + speed_factor_y * 1.0f;
+    
+    // Regras dinâmicas near-edge
+    if (dist_x_edge <= near_edge_threshold) {
+        if (dist_x_edge <= approach_limit && std::abs(v_target_x) > v_thresh) {
+            ptz_speed_x_target = 2.0f; // Aceleração de recuperação
+        } else {
+            ptz_speed_x_target = std::max(1.0f, ptz_speed_x_target * 0.7f);
+        }
+    }
+    
+    if (dist_y_edge <= near_edge_threshold) {
+        if (dist_y_edge <= approach_limit && std::abs(v_target_y) > v_thresh) {
+            ptz_speed_y_target = 2.0f;
+        } else {
+            ptz_speed_y_target = std::max(1.0f, ptz_speed_y_target * 0.7f);
+        }
+    }
+    
+    // Limitar aceleração (slew rate)
+    float max_delta = slew_rate * dt;
+    ptz_speed_x_target = std::clamp(ptz_speed_x_target, 
+                                     prev_ptz_speed_x - max_delta,
+                                     prev_ptz_speed_x + max_delta);
+    ptz_speed_y_target = std::clamp(ptz_speed_y_target,
+                                     prev_ptz_speed_y - max_delta,
+                                     prev_ptz_speed_y + max_delta);
+    
+    // LPF final
+    float alpha_lpf = std::exp(-dt / lpf_tau);
+    float ptz_speed_x = alpha_lpf * prev_ptz_speed_x + (1 - alpha_lpf) * ptz_speed_x_target;
+    float ptz_speed_y = alpha_lpf * prev_ptz_speed_y + (1 - alpha_lpf) * ptz_speed_y_target;
+    
+    // Clamping final
+    ptz_speed_x = std::clamp(ptz_speed_x, 1.0f, 2.0f);
+    ptz_speed_y = std::clamp(ptz_speed_y, 1.0f, 2.0f);
+    
+    // Converter para comandos PTZ com direção
+    // Eixo dentro da zona morta fica parado (copysign de ±0 daria ±1)
+    int pan_cmd = err_x_eff == 0.0f ? 0 :
+        static_cast<int>(ptz_speed_x * std::copysign(1.0f, err_x_eff) * 6.0f);
+    int tilt_cmd = err_y_eff == 0.0f ? 0 :
+        static_cast<int>(-ptz_speed_y * std::copysign(1.0f, err_y_eff) * 5.0f);
+    
+    // Enviar comando apenas se significativo
+    if (std::abs(err_x_eff) > 0.01f || std::abs(err_y_eff) > 0.01f) {
+        cmd.send = true;
+        cmd.pan = pan_cmd;
+        cmd.tilt = tilt_cmd;
+    } else if (!manual_mode) {
+        cmd.send = true;
+    }
+    if (!manual_mode) {
+        cmd.zoom = computeZoom(now, nx, ny);
+    }
+    
+    // Atualizar estados
+    prev_err_x = err_x_eff;
+    prev_err_y = err_y_eff;
+    prev_ptz_speed_x = ptz_speed_x;
+    prev_ptz_speed_y = ptz_speed_y;
+    
+    return cmd;
+}
+
+int TrackingController::computeZoom(double now, float nx, float ny) {
+    if (!auto_zoom) {
+        zoom_dir = 0;
+        return 0;
+    }
+    
+    double vx, vy;
+    predictor.velocity(vx, vy);
+    float speed = (float)std::sqrt(vx * vx + vy * vy);
+    float dist_edge = std::min(std::min(nx, 1.0f - nx), std::min(ny, 1.0f - ny));
+    
+    // Alvo rápido ou perto da borda: afasta antes que saia do quadro
+    if (speed > zoom_fast_motion || dist_edge <= near_edge_threshold) {
+        stable_since = now;
+        zoom_dir = -1;
+        return -zoom_speed_max;
+    }
+    
+    // Só aproxima com o alvo lento e perto do centro: ao fechar o zoom o
+    // deslocamento em relação ao centro aumenta na mesma proporção
+    bool calm = speed < 0.5f * zoom_fast_motion && dist_edge > 2.0f * near_edge_threshold;
+    if (!calm || stable_since < 0) {
+        stable_since = now;
+    }
+    
+    // Histerese: começa a corrigir fora da faixa e para ao cruzar o alvo
+    float ratio = last_nz / zoom_target;
+    if (zoom_dir == 0) {
+        if (ratio > 1.0f + zoom_band) {
+            zoom_dir = -1;
+        } else if (ratio < 1.0f - zoom_band && now - stable_since >= zoom_settle_time) {
+            zoom_dir = 1;
+        }
+    } else if ((zoom_dir > 0) == (ratio >= 1.0f) || (zoom_dir > 0 && !calm)) {
+        zoom_dir = 0;
+    }
+    if (zoom_dir == 0) return 0;
+    
+    // Velocidade proporcional ao erro em escala log (zoom é multiplicativo)
+    int speed_cmd = (int)std::lround(2.0f * std::abs(std::log(ratio)) * zoom_speed_max);
+    return zoom_dir * std::clamp(speed_cmd, 1, zoom_speed_max);
+}
+
+Detection TrackingController::selectBestTarget(const cv::Size& frame,
+                                               const std::vector<Detection>& detections) {
+    Detection best = detections[0];
+    float bestScore = 0;
+    
+    cv::Point2f frameCenter(frame.width / 2.0f, frame.height / 2.0f);
+    
+    for (const auto& det : detections) {
+        cv::Point2f center(det.bbox.x + det.bbox.width / 2.0f,
+                          det.bbox.y + det.bbox.height / 2.0f);
+        
+        float area = det.bbox.width * det.bbox.height;
+        float distToCenter = std::sqrt(std::pow(center.x - frameCenter.x, 2) + 
+                                      std::pow(center.y - frameCenter.y, 2));
+        
+        float score = (area / (distToCenter + 100.0f)) * det.confidence;
+        
+        if (score > bestScore) {
+            bestScore = score;
+            best = det;
+        }
+    }
+    
+    return best;
+}
+
+float TrackingController::applyDeadband(float err) {
+    if (std::abs(err) < deadband) {
+        return 0.0f;
+    }
+    return std::copysign(std::abs(err) - deadband, err);
+}
+
+float TrackingController::applyNonLinearity(float raw_speed) {
+    float abs_speed = std::abs(raw_speed);
+    float a = 1.5f; // Fator de normalização
+    float speed_factor = a * std::pow(abs_speed, gamma);
+    return std::clamp(speed_factor, 0.0f, 1.0f);
+}
@@ -0,0 +1,121 @@
+#ifndef TRACKINGCONTROLLER_H
+#define TRACKINGCONTROLLER_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "YOLODetector.h"
+#include "TargetPredictor.h"
+#include "CameraMotionModel.h"
+
+// Comando de velocidade pan/tilt calculado pelo controle
+struct PTZCommand {
+    bool send = false;
+    int pan = 0;
+    int tilt = 0;
+    int zoom = 0; // >0 aproxima, <0 afasta (só com auto_zoom)
+};
+
+// Estado interno do controle, gravado pelo SessionRecorder para comparar
+// o replay com a sessão original
+struct ControllerState {
+    float integral_x = 0, integral_y = 0;
+    float prev_err_x = 0, prev_err_y = 0;
+    float filtered_derivative_x = 0, filtered_derivative_y = 0;
+    float prev_ptz_speed_x = 0, prev_ptz_speed_y = 0;
+    float last_nx = 0, last_ny = 0, last_nz = 0;
+    float cam_gain_x = 0, cam_gain_y = 0;
+    int lost_frames = 0;
+    int locked_id = -1;
+    bool target_valid = false;
+    bool manual_mode = false;
+};
+
+// Lógica de seguimento do alvo (seleção + PID) sem dependência de Qt,
+// usada pela CaptureEngine e pelas ferramentas headless.
+// As detecções entram por observe() no ritmo da inferência; o PID roda em
+// step() com dt fixo, sobre a posição prevista pelo TargetPredictor.
+class TrackingController {
+public:
+    TrackingController();
+    
+    // Detecções de um frame, com o timestamp de captura em segundos
+    void observe(const cv::Size& frame, const std::vector<Detection>& detections,
+                 double timestamp);
+    // Um passo do controle em 'now' (mesma base de tempo de observe)
+    PTZCommand step(double now, float dt, bool autoTracking);
+    // observe() + step() no mesmo instante: controle por frame
+    PTZCommand update(const cv::Size& frame, const std::vector<Detection>& detections,
+                      float dt, bool autoTracking);
+    // Volta ao estado de um controle novo (parâmetros preservados)
+    void reset();
+    void setManualTarget(float x, float y);
+    bool isManualMode() const { return manual_mode; }
+    // Última posição normalizada do alvo; false quando o alvo foi perdido
+    bool targetHint(float& nx, float& ny, float& nz) const;
+    // ID da trilha seguida (-1 sem trava ou sem MultiObjectTracker)
+    int lockedTrackId() const { return locked_id; }
+    // Atraso total compensado no último step(): idade da observação + atuação (s)
+    double compensatedDelay() const { return compensated_delay; }
+    ControllerState state() const;
+    
+    // Control parameters
+    float conf_min, nz_min, deadband;
+    float Kp_x, Ki_x, Kd_x;
+    float Kp_y, Ki_y, Kd_y;
+    float I_max, gamma;
+    float near_edge_threshold, approach_limit, v_thresh;
+    float slew_rate, lpf_tau, stop_threshold;
+    int lost_max_frames;
+    
+    // Compensação de latência: o alvo é previsto para o instante em que o
+    // comando chega ao motor, descontando o giro da própria câmera
+    bool latency_compensation;
+    float actuation_delay;          // envio do comando -> motor em movimento (s)
+    float cam_gain_x, cam_gain_y;   // deslocamento na imagem por velocidade VISCA·s, em 1x
+    float zoom_factor;              // zoom atual (1 = grande angular); o deslocamento
+                                    // por velocidade cresce com a distância focal
+    float gain_adapt_rate;          // passo do ajuste online dos ganhos (0 = desligado)
+    
+    // Zoom automático: mantém o tamanho do alvo (nz) perto de zoom_target;
+    // afasta com o alvo rápido ou perto da borda, aproxima quando estável
+    bool auto_zoom;
+    float zoom_target;      // nz desejado
+    float zoom_band;        // histerese relativa em torno de zoom_target
+    float zoom_fast_motion; // velocidade do alvo (frame/s) que força afastar
+    float zoom_settle_time; // alvo estável por este tempo antes de aproximar (s)
+    int zoom_speed_max;     // velocidade VISCA de zoom (1..7)
+
+private:
+    Detection selectBestTarget(const cv::Size& frame, const std::vector<Detection>& detections);
+    void adaptCameraGain(double t, double nx, double ny, double sx, double sy);
+    PTZCommand computeCommand(double now, float dt, bool autoTracking);
+    int computeZoom(double now, float nx, float ny);
+    bool findTarget(const cv::Size& frame, const std::vector<Detection>& detections, Detection& target);
+    float applyDeadband(float err);
+    float gainX() const { return cam_gain_x * zoom_factor; }
+    float gainY() const { return cam_gain_y * zoom_factor; }
+    float applyNonLinearity(float raw_speed);
+    
+    // PID control state
+    float integral_x, integral_y;
+    float prev_err_x, prev_err_y;
+    float filtered_derivative_x, filtered_derivative_y;
+    float prev_ptz_speed_x, prev_ptz_speed_y;
+    float last_nx, last_ny, last_nz;
+    int lost_frames;
+    bool target_valid;
+    int locked_id;
+    TargetPredictor predictor;
+    CameraMotionModel cameraMotion;
+    double last_shift_x, last_shift_y; // giro acumulado na última observação
+    double compensated_delay;
+    int zoom_dir;        // correção de zoom em andamento (histerese)
+    double stable_since; // início do trecho estável (-1 = reiniciar)
+    double update_time; // relógio interno de update()
+    
+    // Manual mode
+    bool manual_mode;
+    float manual_target_x, manual_target_y;
+};
+
+#endif
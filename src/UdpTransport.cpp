@@ -0,0 +1,116 @@
+#include "UdpTransport.h"
+#include <QHostInfo>
+#include <QtEndian>
+#include <algorithm>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int elapsedMs(Clock::time_point since) {
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since).count();
+}
+
+}
+
+UdpTransport::UdpTransport(const QString &host, quint16 port)
+    : host(host), port(port), sequence(0), unansweredSeq(0), retransmits(0)
+{
+}
+
+bool UdpTransport::open() {
+    if (!address.setAddress(host)) {
+        QHostInfo info = QHostInfo::fromName(host);
+        if (info.addresses().isEmpty()) return false;
+        address = info.addresses().first();
+    }
+    
+    if (!socket.bind(QHostAddress(QHostAddress::AnyIPv4), 0)) return false;
+    resetSequence();
+    return true;
+}
+
+void UdpTransport::close() {
+    socket.close();
+    unanswered.clear();
+}
+
+QString UdpTransport::description() const {
+    return QString("udp://%1:%2").arg(host).arg(port);
+}
+
+bool UdpTransport::sendDatagram(PayloadType type, const QByteArray &payload, quint32 seq) {
+    QByteArray datagram(8, 0);
+    qToBigEndian<quint16>(type, datagram.data());
+    qToBigEndian<quint16>((quint16)payload.size(), datagram.data() + 2);
+    qToBigEndian<quint32>(seq, datagram.data() + 4);
+    datagram.append(payload);
+    return socket.writeDatagram(datagram, address, port) == datagram.size();
+}
+
+void UdpTransport::resetSequence() {
+    // A câmera zera o contador esperado; a resposta chega como ControlReply
+    sequence = 0;
+    sendDatagram(ControlCommand, QByteArray(1, (char)0x01), sequence);
+}
+
+bool UdpTransport::send(const QByteArray &packet) {
+    sequence++;
+    unanswered = packet;
+    unansweredSeq = sequence;
+    retransmits = 0;
+    lastSent = Clock::now();
+    return sendDatagram(ViscaCommand, packet, sequence);
+}
+
+void UdpTransport::retransmit() {
+    retransmits++;
+    lastSent = Clock::now();
+    sendDatagram(ViscaCommand, unanswered, unansweredSeq);
+}
+
+bool UdpTransport::waitForReply(QByteArray &bytes, int timeoutMs) {
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    
+    while (true) {
+        while (socket.hasPendingDatagrams()) {
+            QByteArray datagram((int)socket.pendingDatagramSize(), 0);
+            socket.readDatagram(datagram.data(), datagram.size());
+            if (datagram.size() < 8) continue;
+            
+            quint16 type = qFromBigEndian<quint16>(datagram.constData());
+            quint32 seq = qFromBigEndian<quint32>(datagram.constData() + 4);
+            QByteArray payload = datagram.mid(8);
+            
+            if (type == ViscaReply) {
+                if (!unanswered.isEmpty() && seq == unansweredSeq) unanswered.clear();
+                bytes = payload;
+                return true;
+            }
+            if (type == ControlReply && payload.size() >= 2 && (unsigned char)payload[0] == 0x0F) {
+                // 0F 01: sequência fora do esperado (câmera reiniciou); 0F 02: mensagem inválida
+                if ((unsigned char)payload[1] == 0x01) {
+                    resetSequence();
+                    if (!unanswered.isEmpty()) send(unanswered);
+                }
+            }
+        }
+        
+        // Sem resposta a tempo: reenvia com a mesma sequência
+        if (!unanswered.isEmpty() && elapsedMs(lastSent) >= kRetransmitMs) {
+            if (retransmits < kMaxRetransmits) {
+                retransmit();
+            } else {
+                unanswered.clear();
+            }
+        }
+        
+        int remaining = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - Clock::now()).count();
+        if (remaining <= 0) return false;
+        if (!unanswered.isEmpty()) {
+            remaining = std::min(remaining, std::max(1, kRetransmitMs - elapsedMs(lastSent)));
+        }
+        socket.waitForReadyRead(remaining);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef UDPTRANSPORT_H
+#define UDPTRANSPORT_H
+
+#include "ViscaTransport.h"
+#include <QHostAddress>
+#include <QUdpSocket>
+#include <chrono>
+
+// VISCA over IP (protocolo Sony, UDP 52381). Cada pacote leva um
+// cabeçalho de 8 bytes: tipo (2), tamanho do payload (2) e sequência (4).
+// Comandos sem resposta são retransmitidos com a mesma sequência.
+class UdpTransport : public ViscaTransport {
+public:
+    static constexpr quint16 kDefaultPort = 52381;
+    
+    UdpTransport(const QString &host, quint16 port);
+    
+    bool open() override;
+    void close() override;
+    bool send(const QByteArray &packet) override;
+    bool waitForReply(QByteArray &bytes, int timeoutMs) override;
+    QString description() const override;
+
+private:
+    enum PayloadType : quint16 {
+        ViscaCommand = 0x0100,
+        ViscaReply = 0x0111,
+        ControlCommand = 0x0200,
+        ControlReply = 0x0201
+    };
+    
+    static constexpr int kRetransmitMs = 60;
+    static constexpr int kMaxRetransmits = 2;
+    
+    bool sendDatagram(PayloadType type, const QByteArray &payload, quint32 seq);
+    void resetSequence();
+    void retransmit();
+    
+    QString host;
+    quint16 port;
+    QHostAddress address;
+    QUdpSocket socket;
+    
+    quint32 sequence;
+    QByteArray unanswered; // Último comando ainda sem resposta
+    quint32 unansweredSeq;
+    int retransmits;
+    std::chrono::steady_clock::time_point lastSent;
+};
+
+#endif
@@ -1,31 +1,50 @@
 #include "VideoWidget.h"
 
-VideoWidget::VideoWidget(QWidget *parent) : QWidget(parent) {
+VideoWidget::VideoWidget(QWidget *parent) : QWidget(parent), overlayVisible(true) {
     setMinimumSize(640, 480);
     setStyleSheet("background-color: #000;");
+    // paintEvent cobre o widget inteiro: o Qt não precisa limpar o fundo
+    setAttribute(Qt::WA_OpaquePaintEvent);
 }
 
-void VideoWidget::setFrame(const QImage &frame) {
-    qDebug() << "Frame recebido:" << frame.size() << "isNull:" << frame.isNull();
-    currentFrame = frame.copy();
+void VideoWidget::setFrame(const QImage &frame, const FrameOverlay &overlay) {
+    // Cópia rasa: o QImage compartilha o buffer do FramePool. A escala
+    // acontece no paintEvent, uma vez por repintura e não por frame recebido
+    currentFrame = frame;
+    currentOverlay = overlay;
     
-    if (!currentFrame.isNull()) {
-        scaledFrame = currentFrame.scaled(size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        int x = (width() - scaledFrame.width()) / 2;
-        int y = (height() - scaledFrame.height()) / 2;
-        displayRect = QRect(x, y, scaledFrame.width(), scaledFrame.height());
+    if (currentFrame.size() != frameSize) {
+        frameSize = currentFrame.size();
+        updateDisplayRect();
     }
     
     update();
 }
 
+void VideoWidget::setOverlayVisible(bool visible) {
+    overlayVisible = visible;
+    update();
+}
+
+void VideoWidget::resizeEvent(QResizeEvent *event) {
+    QWidget::resizeEvent(event);
+    updateDisplayRect();
+}
+
+void VideoWidget::updateDisplayRect() {
+    if (frameSize.isEmpty()) {
+        displayRect = QRect();
+        return;
+    }
+    QSize scaled = frameSize.scaled(size(), Qt::KeepAspectRatio);
+    displayRect = QRect(QPoint((width() - scaled.width()) / 2, (height() - scaled.height()) / 2), scaled);
+}
+
 void VideoWidget::paintEvent(QPaintEvent *) {
     QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
-    
-    painter.fillRect(rect(), Qt::black);
     
-    if (scaledFrame.isNull()) {
+    if (currentFrame.isNull()) {
+        painter.fillRect(rect(), Qt::black);
         painter.setPen(Qt::white);
         QFont font = painter.font();
         font.setPointSize(14);
@@ -37,20 +56,69 @@ void VideoWidget::paintEvent(QPaintEvent *) {
         painter.setPen(QColor(150, 150, 150));
         painter.drawText(rect().adjusted(0, 50, 0, 0), Qt::AlignCenter, 
             "Clique em 'Iniciar Detecção' para começar");
-    } else {
-        painter.drawImage(displayRect, scaledFrame);
-        painter.setPen(QPen(QColor(42, 130, 218), 2));
-        painter.drawRect(displayRect);
+        return;
+    }
+    
+    // Só as faixas fora da imagem são pintadas de preto
+    QRegion background = QRegion(rect()).subtracted(displayRect);
+    for (const QRect &band : background) {
+        painter.fillRect(band, Qt::black);
+    }
+    
+    // Escala bilinear direto no destino: sem QImage intermediário por frame
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, displayRect.size() != frameSize);
+    painter.drawImage(displayRect, currentFrame);
+    
+    painter.setRenderHint(QPainter::Antialiasing);
+    if (overlayVisible) {
+        drawOverlay(painter);
+    }
+    painter.setPen(QPen(QColor(42, 130, 218), 2));
+    painter.drawRect(displayRect);
+}
+
+void VideoWidget::drawOverlay(QPainter &painter) {
+    if (currentOverlay.boxes.isEmpty()) return;
+    
+    double scale = (double)displayRect.width() / frameSize.width();
+    auto toDisplay = [&](const QRect &r) {
+        return QRectF(displayRect.x() + r.x() * scale, displayRect.y() + r.y() * scale,
+                      r.width() * scale, r.height() * scale);
+    };
+    
+    QFont font = painter.font();
+    font.setPointSize(9);
+    font.setBold(true);
+    painter.setFont(font);
+    QFontMetrics metrics(font);
+    
+    for (const OverlayBox &box : currentOverlay.boxes) {
+        // Alvo travado em laranja, demais pessoas em verde
+        QColor color = box.locked ? QColor(255, 165, 0) : QColor(0, 255, 0);
+        QRectF r = toDisplay(box.rect);
+        
+        painter.setPen(QPen(color, box.locked ? 3 : 2));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRect(r);
+        
+        QRectF labelRect(r.left(), r.top() - metrics.height() - 2,
+                         metrics.horizontalAdvance(box.label) + 6, metrics.height() + 2);
+        painter.fillRect(labelRect, color);
+        painter.setPen(Qt::black);
+        painter.drawText(labelRect, Qt::AlignCenter, box.label);
+        
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(QColor(255, 255, 0));
+        painter.drawEllipse(r.center(), 4, 4);
     }
 }
 
 void VideoWidget::mousePressEvent(QMouseEvent *event) {
     if (displayRect.contains(event->pos())) {
         QPoint relativePos = event->pos() - displayRect.topLeft();
-        float scaleX = (float)currentFrame.width() / scaledFrame.width();
-        float scaleY = (float)currentFrame.height() / scaledFrame.height();
+        float scale = (float)frameSize.width() / displayRect.width();
         
-        QPoint framePos(relativePos.x() * scaleX, relativePos.y() * scaleY);
+        QPoint framePos(relativePos.x() * scale, relativePos.y() * scale);
         emit clicked(framePos);
     }
-}
\ No newline at end of file
+}
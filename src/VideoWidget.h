@@ -5,25 +5,34 @@
 #include <QImage>
 #include <QPainter>
 #include <QMouseEvent>
+#include "FrameOverlay.h"
 
 class VideoWidget : public QWidget {
     Q_OBJECT
 
 public:
     explicit VideoWidget(QWidget *parent = nullptr);
-    void setFrame(const QImage &frame);
+    void setFrame(const QImage &frame, const FrameOverlay &overlay = FrameOverlay());
+    // Liga/desliga caixas e rótulos sem mexer no vídeo
+    void setOverlayVisible(bool visible);
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
 
 signals:
     void clicked(QPoint pos);
 
 private:
+    void updateDisplayRect();
+    void drawOverlay(QPainter &painter);
+    
     QImage currentFrame;
-    QImage scaledFrame;
-    QRect displayRect;
+    FrameOverlay currentOverlay;
+    bool overlayVisible;
+    QSize frameSize;   // geometria do displayRect vale para este tamanho
+    QRect displayRect; // recalculado só no resize ou quando a resolução muda
 };
 
 #endif
@@ -0,0 +1,210 @@
+#include "VirtualPTZCamera.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+std::weak_ptr<VirtualPTZCamera> activeCamera;
+std::mutex activeMutex;
+
+// Curva típica de motor PTZ: lenta nas velocidades baixas, rápida no topo
+std::vector<double> speedTable(int steps, double maxSpeed) {
+    std::vector<double> table(steps + 1, 0.0);
+    for (int i = 1; i <= steps; i++) {
+        table[i] = maxSpeed * std::pow((double)i / steps, 1.6);
+    }
+    return table;
+}
+
+double approach(double value, double target, double maxStep) {
+    return value + std::clamp(target - value, -maxStep, maxStep);
+}
+
+}
+
+SimConfig::SimConfig()
+    : panSpeeds(speedTable(24, 100.0)),
+      tiltSpeeds(speedTable(20, 80.0)),
+      zoomSpeeds(speedTable(7, 1.2))
+{
+}
+
+VirtualPTZCamera::VirtualPTZCamera(const SimConfig& config)
+    : config(config), panVelocity(0), tiltVelocity(0),
+      targetPanVelocity(0), targetTiltVelocity(0), zoomRate(0),
+      homing(false), simTime(0)
+{
+}
+
+bool VirtualPTZCamera::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    source = cv::imread(path, cv::IMREAD_COLOR);
+    if (!source.empty()) return true;
+    
+    if (!video.open(path)) return false;
+    return video.read(source) && !source.empty();
+}
+
+void VirtualPTZCamera::setActive(const std::shared_ptr<VirtualPTZCamera>& camera) {
+    std::lock_guard<std::mutex> lock(activeMutex);
+    activeCamera = camera;
+}
+
+std::shared_ptr<VirtualPTZCamera> VirtualPTZCamera::active() {
+    std::lock_guard<std::mutex> lock(activeMutex);
+    return activeCamera.lock();
+}
+
+void VirtualPTZCamera::setState(const State& state) {
+    std::lock_guard<std::mutex> lock(mutex);
+    current = state;
+    current.zoom = std::clamp(current.zoom, 1.0, config.maxZoom);
+    panVelocity = tiltVelocity = 0;
+}
+
+VirtualPTZCamera::State VirtualPTZCamera::state() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return current;
+}
+
+double VirtualPTZCamera::speedFor(const std::vector<double>& table, int speed) {
+    if (table.empty()) return 0.0;
+    int index = std::min(std::abs(speed), (int)table.size() - 1);
+    return speed < 0 ? -table[index] : table[index];
+}
+
+QByteArray VirtualPTZCamera::handleCommand(const QByteArray& packet) {
+    static const QByteArray ack("\x90\x41\xFF", 3);
+    static const QByteArray completion("\x90\x51\xFF", 3);
+    static const QByteArray syntaxError("\x90\x60\x02\xFF", 4);
+    
+    auto byte = [&packet](int i) { return (unsigned char)packet[i]; };
+    if (packet.size() < 5 || byte(0) != 0x81 || byte(packet.size() - 1) != 0xFF) {
+        return syntaxError;
+    }
+    
+    Command cmd;
+    if (packet.size() == 9 && byte(1) == 0x01 && byte(2) == 0x06 && byte(3) == 0x01) {
+        cmd.kind = Command::Drive;
+        int panDir = byte(6), tiltDir = byte(7);
+        cmd.pan = panDir == 0x02 ? byte(4) : panDir == 0x01 ? -byte(4) : 0;
+        cmd.tilt = tiltDir == 0x01 ? byte(5) : tiltDir == 0x02 ? -byte(5) : 0;
+    } else if (packet.size() == 6 && byte(1) == 0x01 && byte(2) == 0x04 && byte(3) == 0x07) {
+        cmd.kind = Command::Zoom;
+        int p = byte(4);
+        cmd.zoom = (p & 0xF0) == 0x20 ? (p & 0x0F) : (p & 0xF0) == 0x30 ? -(p & 0x0F) : 0;
+    } else if (packet.size() == 5 && byte(1) == 0x01 && byte(2) == 0x06 && byte(3) == 0x04) {
+        cmd.kind = Command::Home;
+    } else if (packet.size() == 6 && byte(1) == 0x01 && byte(2) == 0x06 && byte(3) == 0x06) {
+        return ack + completion; // Menu: nada a simular
+    } else {
+        return syntaxError;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    cmd.applyAt = simTime + config.latencyMs / 1000.0;
+    pending.push_back(cmd);
+    return ack + completion;
+}
+
+void VirtualPTZCamera::apply(const Command& cmd) {
+    switch (cmd.kind) {
+        case Command::Drive:
+            homing = false;
+            targetPanVelocity = speedFor(config.panSpeeds, cmd.pan);
+            targetTiltVelocity = speedFor(config.tiltSpeeds, cmd.tilt);
+            break;
+        case Command::Zoom:
+            zoomRate = speedFor(config.zoomSpeeds, cmd.zoom);
+            break;
+        case Command::Home:
+            homing = true;
+            break;
+    }
+}
+
+double VirtualPTZCamera::panLimit(double zoom) const {
+    return std::max(0.0, (config.sourceHfovDeg - config.hfovDeg / zoom) / 2.0);
+}
+
+double VirtualPTZCamera::tiltLimit(double zoom) const {
+    double sourceVfov = config.sourceHfovDeg * source.rows / std::max(1, source.cols);
+    double vfov = config.hfovDeg / zoom * config.outputSize.height / config.outputSize.width;
+    return std::max(0.0, (sourceVfov - vfov) / 2.0);
+}
+
+void VirtualPTZCamera::step(double dt) {
+    simTime += dt;
+    while (!pending.empty() && pending.front().applyAt <= simTime) {
+        apply(pending.front());
+        pending.pop_front();
+    }
+    
+    if (homing) {
+        // Perfil trapezoidal até (0, 0), freando a tempo de não passar
+        double maxPan = config.panSpeeds.empty() ? 0.0 : config.panSpeeds.back();
+        double maxTilt = config.tiltSpeeds.empty() ? 0.0 : config.tiltSpeeds.back();
+        targetPanVelocity = -std::copysign(std::min(maxPan, std::sqrt(2 * config.panAccel * std::abs(current.pan))), current.pan);
+        targetTiltVelocity = -std::copysign(std::min(maxTilt, std::sqrt(2 * config.tiltAccel * std::abs(current.tilt))), current.tilt);
+        if (std::abs(current.pan) < 0.05 && std::abs(current.tilt) < 0.05) {
+            homing = false;
+            targetPanVelocity = targetTiltVelocity = 0;
+        }
+    }
+    
+    panVelocity = approach(panVelocity, targetPanVelocity, config.panAccel * dt);
+    tiltVelocity = approach(tiltVelocity, targetTiltVelocity, config.tiltAccel * dt);
+    current.pan += panVelocity * dt;
+    current.tilt += tiltVelocity * dt;
+    current.zoom = std::clamp(current.zoom * std::exp(zoomRate * dt), 1.0, config.maxZoom);
+    
+    // Fim de curso: a janela não sai da fonte
+    double pl = panLimit(current.zoom), tl = tiltLimit(current.zoom);
+    if (std::abs(current.pan) > pl) {
+        current.pan = std::copysign(pl, current.pan);
+        panVelocity = 0;
+    }
+    if (std::abs(current.tilt) > tl) {
+        current.tilt = std::copysign(tl, current.tilt);
+        tiltVelocity = 0;
+    }
+}
+
+void VirtualPTZCamera::advance(double dt) {
+    std::lock_guard<std::mutex> lock(mutex);
+    step(dt);
+}
+
+cv::Rect2d VirtualPTZCamera::viewWindow(const State& s) const {
+    double pxPerDeg = source.cols / config.sourceHfovDeg;
+    double width = config.hfovDeg / s.zoom * pxPerDeg;
+    double height = width * config.outputSize.height / config.outputSize.width;
+    double cx = source.cols / 2.0 + s.pan * pxPerDeg;
+    double cy = source.rows / 2.0 - s.tilt * pxPerDeg;
+    return cv::Rect2d(cx - width / 2, cy - height / 2, width, height);
+}
+
+bool VirtualPTZCamera::read(cv::Mat& frame, double dt) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (source.empty()) return false;
+    
+    if (video.isOpened()) {
+        cv::Mat next;
+        if (!video.read(next)) {
+            video.set(cv::CAP_PROP_POS_FRAMES, 0); // Vídeo em loop
+            video.read(next);
+        }
+        if (!next.empty()) source = next;
+    }
+    
+    step(dt);
+    
+    // Recorte + escala numa única warpAffine
+    cv::Rect2d view = viewWindow(current);
+    double scale = config.outputSize.width / view.width;
+    cv::Mat transform = (cv::Mat_<double>(2, 3) << scale, 0, -view.x * scale,
+                                                   0, scale, -view.y * scale);
+    cv::warpAffine(source, frame, transform, config.outputSize,
+                   cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+    return true;
+}
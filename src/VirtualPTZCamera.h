@@ -0,0 +1,91 @@
+#ifndef VIRTUALPTZCAMERA_H
+#define VIRTUALPTZCAMERA_H
+
+#include <QByteArray>
+#include <opencv2/opencv.hpp>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Parâmetros do motor simulado
+struct SimConfig {
+    cv::Size outputSize{640, 480};
+    double sourceHfovDeg = 120.0; // FOV horizontal coberto pela fonte inteira
+    double hfovDeg = 60.0;        // FOV da câmera em zoom 1x
+    double maxZoom = 10.0;
+    double latencyMs = 80.0;      // comando -> início do movimento
+    double panAccel = 240.0;      // °/s²
+    double tiltAccel = 240.0;
+    // Velocidade (°/s ou log-zoom/s) por índice de velocidade VISCA
+    std::vector<double> panSpeeds;  // 0..24
+    std::vector<double> tiltSpeeds; // 0..20
+    std::vector<double> zoomSpeeds; // 0..7
+    
+    SimConfig();
+};
+
+// Câmera PTZ virtual: recorta uma janela de um panorama ou vídeo em alta
+// resolução; pan/tilt/zoom seguem os comandos VISCA recebidos, com
+// latência, aceleração e tabela de velocidades do motor. Usada como fonte
+// "sim:<arquivo>" na CaptureEngine e em malha fechada no ptz_bench.
+class VirtualPTZCamera {
+public:
+    struct State {
+        double pan = 0;  // graus, positivo à direita
+        double tilt = 0; // graus, positivo para cima
+        double zoom = 1;
+    };
+    
+    explicit VirtualPTZCamera(const SimConfig& config = SimConfig());
+    
+    bool open(const std::string& source); // imagem (panorama) ou vídeo
+    
+    // Aplica um pacote VISCA e devolve as respostas (ACK + conclusão ou erro)
+    QByteArray handleCommand(const QByteArray& packet);
+    
+    // Avança a simulação dt segundos e renderiza a janela atual
+    bool read(cv::Mat& frame, double dt);
+    // Só avança o motor (passos de controle entre frames)
+    void advance(double dt);
+    
+    void setState(const State& state);
+    State state() const;
+    
+    // Câmera usada pelo transporte "sim" do PTZController
+    static void setActive(const std::shared_ptr<VirtualPTZCamera>& camera);
+    static std::shared_ptr<VirtualPTZCamera> active();
+
+private:
+    struct Command {
+        enum Kind { Drive, Zoom, Home } kind = Drive;
+        int pan = 0;  // velocidade VISCA com sinal
+        int tilt = 0;
+        int zoom = 0;
+        double applyAt = 0;
+    };
+    
+    void step(double dt);
+    void apply(const Command& cmd);
+    cv::Rect2d viewWindow(const State& s) const;
+    double panLimit(double zoom) const;
+    double tiltLimit(double zoom) const;
+    static double speedFor(const std::vector<double>& table, int speed);
+    
+    SimConfig config;
+    mutable std::mutex mutex;
+    
+    cv::VideoCapture video;
+    cv::Mat source;
+    
+    State current;
+    double panVelocity, tiltVelocity;           // °/s atuais
+    double targetPanVelocity, targetTiltVelocity;
+    double zoomRate;                            // log-zoom/s
+    bool homing;
+    double simTime;
+    std::deque<Command> pending;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "ViscaProtocol.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace Visca {
+
+QByteArray panTiltDrive(int pan, int tilt) {
+    unsigned char panSpd = std::min(std::abs(pan), 24);
+    unsigned char tiltSpd = std::min(std::abs(tilt), 20);
+    unsigned char panDir = (pan > 0) ? 0x02 : (pan < 0) ? 0x01 : 0x03;
+    unsigned char tiltDir = (tilt > 0) ? 0x01 : (tilt < 0) ? 0x02 : 0x03;
+    
+    QByteArray cmd;
+    cmd.append((char)0x81);
+    cmd.append((char)0x01);
+    cmd.append((char)0x06);
+    cmd.append((char)0x01);
+    cmd.append((char)panSpd);
+    cmd.append((char)tiltSpd);
+    cmd.append((char)panDir);
+    cmd.append((char)tiltDir);
+    cmd.append((char)0xFF);
+    return cmd;
+}
+
+QByteArray zoomDrive(int speed) {
+    QByteArray cmd;
+    cmd.append((char)0x81);
+    cmd.append((char)0x01);
+    cmd.append((char)0x04);
+    cmd.append((char)0x07);
+    
+    unsigned char spd = std::min(std::abs(speed), 7);
+    if (speed > 0) {
+        cmd.append((char)(0x20 + spd));
+    } else if (speed < 0) {
+        cmd.append((char)(0x30 + spd));
+    } else {
+        cmd.append((char)0x00);
+    }
+    
+    cmd.append((char)0xFF);
+    return cmd;
+}
+
+QByteArray home() {
+    QByteArray cmd;
+    cmd.append((char)0x81);
+    cmd.append((char)0x01);
+    cmd.append((char)0x06);
+    cmd.append((char)0x04);
+    cmd.append((char)0xFF);
+    return cmd;
+}
+
+QByteArray stop() {
+    return panTiltDrive(0, 0);
+}
+
+QByteArray menu() {
+    QByteArray cmd;
+    cmd.append((char)0x81);
+    cmd.append((char)0x01);
+    cmd.append((char)0x06);
+    cmd.append((char)0x06);
+    cmd.append((char)0x02);
+    cmd.append((char)0xFF);
+    return cmd;
+}
+
+QString errorText(int code) {
+    switch (code) {
+        case MessageLengthError: return "tamanho de mensagem inválido";
+        case SyntaxError: return "erro de sintaxe";
+        case BufferFull: return "buffer de comandos cheio";
+        case CommandCanceled: return "comando cancelado";
+        case NoSocket: return "socket inexistente";
+        case NotExecutable: return "comando não executável agora";
+        default: return QString("erro 0x%1").arg(code, 2, 16, QChar('0'));
+    }
+}
+
+QString toHex(const QByteArray &bytes) {
+    QString hex;
+    for (unsigned char byte : bytes) {
+        hex += QString::number(byte, 16).toUpper().rightJustified(2, '0') + " ";
+    }
+    return hex.trimmed();
+}
+
+void ReplyParser::feed(const QByteArray &bytes) {
+    for (char c : bytes) {
+        buffer.append(c);
+        if ((unsigned char)c != 0xFF) {
+            // Lixo na linha: nenhuma resposta VISCA passa de 16 bytes
+            if (buffer.size() > 16) buffer.clear();
+            continue;
+        }
+        
+        QByteArray packet = buffer;
+        buffer.clear();
+        if (packet.size() < 3 || ((unsigned char)packet[0] & 0x80) == 0) continue;
+        
+        unsigned char kind = (unsigned char)packet[1] & 0xF0;
+        Reply reply;
+        reply.socket = (unsigned char)packet[1] & 0x0F;
+        if (kind == 0x40) {
+            reply.type = Reply::Ack;
+        } else if (kind == 0x50) {
+            reply.type = Reply::Completion;
+        } else if (kind == 0x60 && packet.size() >= 4) {
+            reply.type = Reply::Error;
+            reply.errorCode = (unsigned char)packet[2];
+        } else {
+            continue; // Address set, network change etc.
+        }
+        replies.push_back(reply);
+    }
+}
+
+bool ReplyParser::next(Reply &reply) {
+    if (replies.empty()) return false;
+    reply = replies.front();
+    replies.pop_front();
+    return true;
+}
+
+void ReplyParser::reset() {
+    buffer.clear();
+    replies.clear();
+}
+
+}
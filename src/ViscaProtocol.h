@@ -0,0 +1,51 @@
+#ifndef VISCAPROTOCOL_H
+#define VISCAPROTOCOL_H
+
+#include <QByteArray>
+#include <QString>
+#include <deque>
+
+// Montagem de comandos VISCA (câmera 1) e parser das respostas.
+namespace Visca {
+
+QByteArray panTiltDrive(int pan, int tilt); // pan ±24, tilt ±20; 0 = parado
+QByteArray zoomDrive(int speed);            // ±7; 0 = parado
+QByteArray home();
+QByteArray stop();
+QByteArray menu();
+
+struct Reply {
+    enum Type { Ack, Completion, Error };
+    Type type = Ack;
+    int socket = 0;    // 1 ou 2 (0 em erros de sintaxe/buffer cheio)
+    int errorCode = 0; // só em Error
+};
+
+// Códigos de erro (y0 6z ee FF)
+enum ErrorCode {
+    MessageLengthError = 0x01,
+    SyntaxError = 0x02,
+    BufferFull = 0x03,
+    CommandCanceled = 0x04,
+    NoSocket = 0x05,
+    NotExecutable = 0x41
+};
+
+QString errorText(int code);
+QString toHex(const QByteArray &bytes);
+
+// Remonta pacotes terminados em 0xFF a partir de leituras parciais
+class ReplyParser {
+public:
+    void feed(const QByteArray &bytes);
+    bool next(Reply &reply);
+    void reset();
+
+private:
+    QByteArray buffer;
+    std::deque<Reply> replies;
+};
+
+}
+
+#endif
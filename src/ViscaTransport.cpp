@@ -0,0 +1,16 @@
+#include "ViscaTransport.h"
+#include "SerialTransport.h"
+#include "UdpTransport.h"
+#include "SimTransport.h"
+#include <QUrl>
+
+std::unique_ptr<ViscaTransport> ViscaTransport::create(const QString &port, int baudrate) {
+    if (port == "sim") {
+        return std::make_unique<SimTransport>();
+    }
+    if (port.startsWith("udp://")) {
+        QUrl url(port);
+        return std::make_unique<UdpTransport>(url.host(), (quint16)url.port(UdpTransport::kDefaultPort));
+    }
+    return std::make_unique<SerialTransport>(port, baudrate);
+}
@@ -0,0 +1,31 @@
+#ifndef VISCATRANSPORT_H
+#define VISCATRANSPORT_H
+
+#include <QByteArray>
+#include <QString>
+#include <memory>
+
+// Meio físico do VISCA sob o PTZController (serial ou IP).
+// Os objetos são criados e usados somente pela thread de I/O.
+class ViscaTransport {
+public:
+    virtual ~ViscaTransport() = default;
+    
+    virtual bool open() = 0;
+    virtual void close() = 0;
+    
+    // Envia um pacote VISCA completo (81 ... FF)
+    virtual bool send(const QByteArray &packet) = 0;
+    
+    // Espera até timeoutMs por bytes de resposta VISCA (sem cabeçalhos do
+    // transporte). Retransmissões, se houver, acontecem aqui dentro.
+    virtual bool waitForReply(QByteArray &bytes, int timeoutMs) = 0;
+    
+    virtual QString description() const = 0;
+    
+    // "udp://host[:porta]" usa VISCA over IP, "sim" a câmera virtual ativa;
+    // qualquer outro nome é porta serial
+    static std::unique_ptr<ViscaTransport> create(const QString &port, int baudrate);
+};
+
+#endif
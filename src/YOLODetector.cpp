@@ -1,88 +1,421 @@
 #include "YOLODetector.h"
+#include <opencv2/core/hal/intrin.hpp>
 #include <algorithm>
+#include <chrono>
 
-YOLODetector::YOLODetector(const std::string& modelPath, float confThreshold)
-    : confidenceThreshold(confThreshold), nmsThreshold(0.45f)
+namespace {
+
+double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+#if CV_SIMD128
+// Expande 16 bytes para 16 floats escalados e grava num plano
+inline void storeScaled(const cv::v_uint8x16& v, float* dst, const cv::v_float32x4& scale) {
+    const cv::v_float32x4 zero = cv::v_setzero_f32();
+    cv::v_uint16x8 lo, hi;
+    cv::v_expand(v, lo, hi);
+    cv::v_uint32x4 a, b, c, d;
+    cv::v_expand(lo, a, b);
+    cv::v_expand(hi, c, d);
+    cv::v_store(dst,      cv::v_muladd(cv::v_cvt_f32(cv::v_reinterpret_as_s32(a)), scale, zero));
+    cv::v_store(dst + 4,  cv::v_muladd(cv::v_cvt_f32(cv::v_reinterpret_as_s32(b)), scale, zero));
+    cv::v_store(dst + 8,  cv::v_muladd(cv::v_cvt_f32(cv::v_reinterpret_as_s32(c)), scale, zero));
+    cv::v_store(dst + 12, cv::v_muladd(cv::v_cvt_f32(cv::v_reinterpret_as_s32(d)), scale, zero));
+}
+#endif
+
+// BGR intercalado (HWC) -> RGB planar (CHW) * 1/255 em uma única passada
+void packPlanarRGB(const cv::Mat& bgr, float* dst) {
+    const int width = bgr.cols;
+    const size_t plane = (size_t)width * bgr.rows;
+    float* dstR = dst;
+    float* dstG = dst + plane;
+    float* dstB = dst + 2 * plane;
+    
+    cv::parallel_for_(cv::Range(0, bgr.rows), [&](const cv::Range& range) {
+        const float scale = 1.0f / 255.0f;
+#if CV_SIMD128
+        const cv::v_float32x4 vscale = cv::v_setall_f32(scale);
+#endif
+        for (int y = range.start; y < range.end; y++) {
+            const uchar* src = bgr.ptr<uchar>(y);
+            size_t offset = (size_t)y * width;
+            int x = 0;
+#if CV_SIMD128
+            for (; x <= width - 16; x += 16) {
+                cv::v_uint8x16 b, g, r;
+                cv::v_load_deinterleave(src + x * 3, b, g, r);
+                storeScaled(r, dstR + offset + x, vscale);
+                storeScaled(g, dstG + offset + x, vscale);
+                storeScaled(b, dstB + offset + x, vscale);
+            }
+#endif
+            for (; x < width; x++) {
+                dstB[offset + x] = src[x * 3] * scale;
+                dstG[offset + x] = src[x * 3 + 1] * scale;
+                dstR[offset + x] = src[x * 3 + 2] * scale;
+            }
+        }
+    });
+}
+
+}
+
+YOLODetector::YOLODetector(const std::string& modelPath, float confThreshold,
+                           const BackendConfig& backendConfig)
+    : confidenceThreshold(confThreshold), nmsThreshold(0.45f),
+      maxDetections(100),
+      currentSlot(0), defaultSlot(0), inputWidth(416), inputHeight(416),
+      letterbox(false), batchSupported(true),
+      latencyBudgetMs(0), targetHintPx(0), pendingSlot(-1), pendingFrames(0)
 {
-    // Carrega modelo YOLO ONNX
-    net = cv::dnn::readNetFromONNX(modelPath);
-    net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-    net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    // Carrega modelo YOLO ONNX no backend escolhido
+    backend = InferenceBackend::create(modelPath, backendConfig);
     
     // Classes COCO (apenas pessoa = 0)
     classNames = {"person"};
+    
+    setInputSizes({kNativeInputSize});
+}
+
+void YOLODetector::setInputSizes(const std::vector<int>& sizes) {
+    std::vector<int> sorted;
+    for (int s : sizes) {
+        // Múltiplo do stride máximo do YOLO (32)
+        if (s >= 64) sorted.push_back(s / 32 * 32);
+    }
+    sorted.push_back(kNativeInputSize);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    
+    // Buffers de entrada alocados uma única vez por tamanho
+    inputSlots.clear();
+    for (int s : sorted) {
+        InputSlot slot;
+        slot.size = s;
+        slot.canvas.create(s, s, CV_8UC3);
+        int blobDims[] = {1, 3, s, s};
+        slot.blob.create(4, blobDims, CV_32F);
+        inputSlots.push_back(std::move(slot));
+    }
+    defaultSlot = (int)(std::find(sorted.begin(), sorted.end(), kNativeInputSize) - sorted.begin());
+    pendingSlot = -1;
+    pendingFrames = 0;
+    activateSlot(defaultSlot);
+}
+
+std::vector<int> YOLODetector::inputSizes() const {
+    std::vector<int> sizes;
+    for (const auto& slot : inputSlots) sizes.push_back(slot.size);
+    return sizes;
+}
+
+void YOLODetector::setLatencyBudget(double ms) {
+    latencyBudgetMs = std::max(0.0, ms);
+}
+
+void YOLODetector::setTargetHint(float pixels) {
+    targetHintPx = std::max(0.0f, pixels);
+}
+
+void YOLODetector::activateSlot(int slot) {
+    currentSlot = slot;
+    inputWidth = inputSlots[slot].size;
+    inputHeight = inputSlots[slot].size;
+}
+
+double YOLODetector::estimatedCost(int slot) const {
+    if (inputSlots[slot].costMs > 0) return inputSlots[slot].costMs;
+    
+    // Sem medida: extrapola pela área a partir do tamanho medido mais próximo
+    double best = 0;
+    int bestDist = 0;
+    for (int i = 0; i < (int)inputSlots.size(); i++) {
+        if (inputSlots[i].costMs <= 0) continue;
+        int dist = std::abs(i - slot);
+        if (best == 0 || dist < bestDist) {
+            double ratio = (double)inputSlots[slot].size / inputSlots[i].size;
+            best = inputSlots[i].costMs * ratio * ratio;
+            bestDist = dist;
+        }
+    }
+    return best;
+}
+
+int YOLODetector::chooseSlot(const cv::Size& frameSize, float targetPx) const {
+    // Sem orçamento, ou antes da primeira medida: tamanho nativo
+    if (latencyBudgetMs <= 0 || estimatedCost(defaultSlot) <= 0) return defaultSlot;
+    
+    // Maior entrada que cabe no orçamento; a menor suportada é sempre aceita
+    int cap = -1;
+    for (int i = 0; i < (int)inputSlots.size(); i++) {
+        if (!inputSlots[i].supported) continue;
+        if (cap < 0 || estimatedCost(i) <= latencyBudgetMs) cap = i;
+    }
+    if (cap < 0) return defaultSlot;
+    if (targetPx <= 0) return cap; // Sem alvo: procura com a maior resolução possível
+    
+    // Menor entrada em que o alvo ainda tem kMinTargetPixels na rede
+    float frameSide = (float)std::max(frameSize.width, frameSize.height);
+    for (int i = 0; i < cap; i++) {
+        if (inputSlots[i].supported && targetPx * inputSlots[i].size / frameSide >= kMinTargetPixels) {
+            return i;
+        }
+    }
+    return cap;
+}
+
+cv::Size YOLODetector::upcomingInputSize(const cv::Size& frameSize) const {
+    // Recorte menor só pode escolher entrada menor ou igual (slots em ordem
+    // crescente); a histerese pode manter a atual ou ativar a escolhida
+    int side = std::max(inputSlots[currentSlot].size, inputSlots[chooseSlot(frameSize, targetHintPx)].size);
+    return cv::Size(side, side);
+}
+
+void YOLODetector::selectSlot(int wanted) {
+    if (wanted == currentSlot) {
+        pendingFrames = 0;
+        return;
+    }
+    
+    // Histerese: troca só depois de alguns frames com a mesma escolha
+    if (wanted != pendingSlot) {
+        pendingSlot = wanted;
+        pendingFrames = 0;
+    }
+    if (++pendingFrames >= kSwitchFrames || inputSlots[currentSlot].costMs <= 0) {
+        activateSlot(wanted);
+        pendingFrames = 0;
+    }
 }
 
 void YOLODetector::setConfidenceThreshold(float threshold) {
     confidenceThreshold = threshold;
 }
 
+void YOLODetector::setLetterbox(bool enabled) {
+    letterbox = enabled;
+    for (auto& slot : inputSlots) {
+        slot.frameSize = cv::Size(); // Força recálculo da geometria
+    }
+}
+
+LetterboxInfo YOLODetector::preprocess(const cv::Mat& frame, float* dst) {
+    InputSlot& slot = inputSlots[currentSlot];
+    
+    // Geometria só é recalculada quando a resolução do frame muda
+    if (frame.size() != slot.frameSize) {
+        slot.frameSize = frame.size();
+        slot.info = LetterboxInfo();
+        
+        if (letterbox) {
+            float s = std::min((float)inputWidth / frame.cols, (float)inputHeight / frame.rows);
+            slot.info.scaleX = s;
+            slot.info.scaleY = s;
+            slot.info.padX = (inputWidth - cvRound(frame.cols * s)) / 2;
+            slot.info.padY = (inputHeight - cvRound(frame.rows * s)) / 2;
+            slot.canvas.setTo(cv::Scalar(114, 114, 114));
+        } else {
+            slot.info.scaleX = (float)inputWidth / frame.cols;
+            slot.info.scaleY = (float)inputHeight / frame.rows;
+        }
+    }
+    
+    if (frame.cols == inputWidth && frame.rows == inputHeight && frame.type() == CV_8UC3) {
+        packPlanarRGB(frame, dst);
+        return slot.info;
+    }
+    
+    cv::Rect roi(slot.info.padX, slot.info.padY,
+                 inputWidth - 2 * slot.info.padX, inputHeight - 2 * slot.info.padY);
+    cv::Mat target = slot.canvas(roi);
+    cv::resize(frame, target, roi.size(), 0, 0, cv::INTER_LINEAR);
+    
+    packPlanarRGB(slot.canvas, dst);
+    return slot.info;
+}
+
 std::vector<Detection> YOLODetector::detect(const cv::Mat& frame) {
-    // Preprocessamento
-    cv::Mat blob;
-    cv::dnn::blobFromImage(frame, blob, 1.0/255.0, 
-        cv::Size(416, 416), cv::Scalar(), true, false);
+    selectSlot(chooseSlot(frame.size(), targetHintPx));
+    InputSlot& slot = inputSlots[currentSlot];
+    auto t0 = std::chrono::steady_clock::now();
     
-    net.setInput(blob);
+    // Preprocessamento direto no tensor persistente
+    LetterboxInfo info = preprocess(frame, slot.blob.ptr<float>());
+    timings.preprocessMs = elapsedMs(t0);
     
     // Forward pass
-    std::vector<cv::Mat> outputs;
-    net.forward(outputs, net.getUnconnectedOutLayersNames());
+    auto t1 = std::chrono::steady_clock::now();
+    try {
+        backend->forward(slot.blob, outputs);
+    } catch (const std::exception&) {
+        if (currentSlot == defaultSlot) throw;
+        // Modelo com forma estática: só o tamanho nativo é aceito
+        slot.supported = false;
+        activateSlot(defaultSlot);
+        return detect(frame);
+    }
+    timings.forwardMs = elapsedMs(t1);
+    timings.inputSize = slot.size;
+    
+    double cost = timings.preprocessMs + timings.forwardMs;
+    slot.costMs = slot.costMs > 0 ? 0.8 * slot.costMs + 0.2 * cost : cost;
     
     // Parse detecções
-    return parseDetections(outputs, frame.size());
+    auto t2 = std::chrono::steady_clock::now();
+    auto detections = parseDetections(outputs[0], 0, info);
+    timings.decodeMs = elapsedMs(t2);
+    
+    return detections;
+}
+
+std::vector<std::vector<Detection>> YOLODetector::detectBatch(const std::vector<cv::Mat>& frames,
+                                                               const std::vector<float>& targetHints) {
+    std::vector<std::vector<Detection>> results;
+    
+    if (frames.size() <= 1 || !batchSupported) {
+        float hint = targetHintPx;
+        for (size_t i = 0; i < frames.size(); i++) {
+            if (i < targetHints.size()) targetHintPx = targetHints[i];
+            results.push_back(detect(frames[i]));
+        }
+        targetHintPx = hint;
+        return results;
+    }
+    
+    // Uma entrada para o lote: a maior entre as escolhidas por frame
+    int wanted = 0;
+    for (size_t i = 0; i < frames.size(); i++) {
+        float hint = i < targetHints.size() ? targetHints[i] : targetHintPx;
+        wanted = std::max(wanted, chooseSlot(frames[i].size(), hint));
+    }
+    selectSlot(wanted);
+    InputSlot& slot = inputSlots[currentSlot];
+    
+    // Tensor em lote só é realocado quando N ou a entrada mudam
+    int batchDims[] = {(int)frames.size(), 3, inputHeight, inputWidth};
+    batchBlob.create(4, batchDims, CV_32F);
+    
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<LetterboxInfo> infos;
+    infos.reserve(frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        infos.push_back(preprocess(frames[i], batchBlob.ptr<float>((int)i)));
+    }
+    timings.preprocessMs = elapsedMs(t0);
+    timings.inputSize = slot.size;
+    
+    auto t1 = std::chrono::steady_clock::now();
+    try {
+        backend->forward(batchBlob, outputs);
+    } catch (const std::exception&) {
+        // Modelo com batch estático: volta para forwards individuais
+        // (o detect() cuida do fallback de forma estática)
+        batchSupported = false;
+        return detectBatch(frames, targetHints);
+    }
+    timings.forwardMs = elapsedMs(t1);
+    
+    // Cada câmera espera o lote inteiro: é esse o custo por frame
+    double cost = timings.preprocessMs + timings.forwardMs;
+    slot.costMs = slot.costMs > 0 ? 0.8 * slot.costMs + 0.2 * cost : cost;
+    
+    auto t2 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < frames.size(); i++) {
+        results.push_back(parseDetections(outputs[0], (int)i, infos[i]));
+    }
+    timings.decodeMs = elapsedMs(t2);
+    
+    return results;
+}
+
+void YOLODetector::scanConfidences(const float* conf, int count, float threshold) {
+    survivors.clear();
+    int i = 0;
+    
+#if CV_SIMD128
+    // conf - threshold: bit de sinal zerado => conf >= threshold
+    const cv::v_float32x4 one = cv::v_setall_f32(1.0f);
+    const cv::v_float32x4 negThr = cv::v_setall_f32(-threshold);
+    for (; i <= count - 16; i += 16) {
+        int below = cv::v_signmask(cv::v_muladd(cv::v_load(conf + i), one, negThr)) |
+                    cv::v_signmask(cv::v_muladd(cv::v_load(conf + i + 4), one, negThr)) << 4 |
+                    cv::v_signmask(cv::v_muladd(cv::v_load(conf + i + 8), one, negThr)) << 8 |
+                    cv::v_signmask(cv::v_muladd(cv::v_load(conf + i + 12), one, negThr)) << 12;
+        int mask = ~below & 0xFFFF;
+        
+        // Caso comum: nenhuma âncora passa no bloco
+        for (int bit = 0; mask; bit++, mask >>= 1) {
+            if (mask & 1) survivors.push_back(i + bit);
+        }
+    }
+#endif
+    
+    for (; i < count; i++) {
+        if (conf[i] >= threshold) survivors.push_back(i);
+    }
 }
 
 std::vector<Detection> YOLODetector::parseDetections(
-    const std::vector<cv::Mat>& outputs,
-    const cv::Size& frameSize)
+    const cv::Mat& output,
+    int batchIndex,
+    const LetterboxInfo& info)
 {
-    std::vector<Detection> detections;
-    std::vector<cv::Rect> boxes;
-    std::vector<float> confidences;
-    std::vector<int> classIds;
+    float x_factor = 1.0f / info.scaleX;
+    float y_factor = 1.0f / info.scaleY;
     
-    float x_factor = frameSize.width / 416.0f;
-    float y_factor = frameSize.height / 416.0f;
+    // Saída [N, 4 + classes, anchors]: cada imagem do lote é uma fatia
+    const float* data = output.ptr<float>(batchIndex);
+    int rows = output.size[2];
     
-    for (const auto& output : outputs) {
-        float* data = (float*)output.data;
-        
-        int dimensions = output.size[1];
-        int rows = output.size[2];
+    // 1) Varredura da linha contígua de confiança (classe pessoa)
+    scanConfidences(data + 4 * rows, rows, confidenceThreshold);
+    
+    // 2) Decodifica coordenadas apenas dos sobreviventes
+    candidates.clear();
+    for (int index : survivors) {
+        float x = data[index] - info.padX;
+        float y = data[index + rows] - info.padY;
+        float w = data[index + 2 * rows];
+        float h = data[index + 3 * rows];
         
-        for (int i = 0; i < rows; i++) {
-            int index = i;
-            float x = data[index];
-            float y = data[index + rows];
-            float w = data[index + 2 * rows];
-            float h = data[index + 3 * rows];
-            float confidence = data[index + 4 * rows];
-            
-            if (confidence >= confidenceThreshold) {
-                int left = (int)((x - w/2) * x_factor);
-                int top = (int)((y - h/2) * y_factor);
-                int width = (int)(w * x_factor);
-                int height = (int)(h * y_factor);
-                
-                boxes.push_back(cv::Rect(left, top, width, height));
-                confidences.push_back(confidence);
-                classIds.push_back(0);
-            }
-        }
+        Candidate c;
+        c.box = cv::Rect2f((x - w/2) * x_factor, (y - h/2) * y_factor,
+                           w * x_factor, h * y_factor);
+        c.score = data[index + 4 * rows];
+        c.classId = 0;
+        candidates.push_back(c);
     }
     
-    std::vector<int> indices;
-    cv::dnn::NMSBoxes(boxes, confidences, confidenceThreshold, nmsThreshold, indices);
+    // 3) NMS guloso por classe sobre a lista ordenada por confiança
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+    
+    std::vector<Detection> detections;
+    suppressed.assign(candidates.size(), 0);
     
-    for (int idx : indices) {
+    for (size_t i = 0; i < candidates.size() && (int)detections.size() < maxDetections; i++) {
+        if (suppressed[i]) continue;
+        const Candidate& keep = candidates[i];
+        
         Detection det;
-        det.bbox = boxes[idx];
-        det.confidence = confidences[idx];
-        det.classId = classIds[idx];
+        det.bbox = cv::Rect((int)keep.box.x, (int)keep.box.y,
+                            (int)keep.box.width, (int)keep.box.height);
+        det.confidence = keep.score;
+        det.classId = keep.classId;
         det.label = "Person";
         detections.push_back(det);
+        
+        float keepArea = keep.box.area();
+        for (size_t j = i + 1; j < candidates.size(); j++) {
+            if (suppressed[j] || candidates[j].classId != keep.classId) continue;
+            
+            float inter = (keep.box & candidates[j].box).area();
+            float iou = inter / (keepArea + candidates[j].box.area() - inter + 1e-6f);
+            if (iou > nmsThreshold) suppressed[j] = 1;
+        }
     }
     
     return detections;
-}
\ No newline at end of file
+}
@@ -2,32 +2,123 @@
 #define YOLODETECTOR_H
 
 #include <opencv2/opencv.hpp>
-#include <opencv2/dnn.hpp>
 #include <vector>
 #include <string>
+#include <memory>
+#include "InferenceBackend.h"
 
 struct Detection {
     cv::Rect bbox;
     float confidence;
     int classId;
     std::string label;
+    int trackId = -1; // ID persistente do MultiObjectTracker (-1 = sem trilha)
+};
+
+// Tempo gasto em cada etapa do último detect()/detectBatch()
+struct DetectorTimings {
+    double preprocessMs = 0;
+    double forwardMs = 0;
+    double decodeMs = 0;
+    int inputSize = 0; // lado da entrada da rede usada
+};
+
+// Mapeamento entre coordenadas da entrada da rede e do frame original
+struct LetterboxInfo {
+    float scaleX = 1.0f;
+    float scaleY = 1.0f;
+    int padX = 0;
+    int padY = 0;
 };
 
 class YOLODetector {
 public:
-    YOLODetector(const std::string& modelPath, float confThreshold = 0.5f);
+    YOLODetector(const std::string& modelPath, float confThreshold = 0.5f,
+                 const BackendConfig& backendConfig = BackendConfig());
     std::vector<Detection> detect(const cv::Mat& frame);
+    // Um único forward com N frames (N câmeras); resultados na mesma ordem.
+    // targetHints: lado do alvo por frame (vazio = o de setTargetHint); o
+    // lote usa a maior entrada escolhida entre os frames
+    std::vector<std::vector<Detection>> detectBatch(const std::vector<cv::Mat>& frames,
+                                                    const std::vector<float>& targetHints = {});
     void setConfidenceThreshold(float threshold);
+    void setLetterbox(bool enabled);
+    cv::Size inputSize() const { return cv::Size(inputWidth, inputHeight); }
+    
+    // Entrada adaptativa: lados (quadrados) permitidos para a rede. O
+    // tamanho nativo (416) é sempre incluído e serve de fallback para
+    // modelos exportados com forma estática.
+    void setInputSizes(const std::vector<int>& sizes);
+    std::vector<int> inputSizes() const;
+    // Custo máximo de preprocess + forward por frame (0 = tamanho fixo)
+    void setLatencyBudget(double ms);
+    // Lado do alvo em pixels do frame (0 = sem alvo): alvo grande usa a
+    // entrada menor que ainda o resolve
+    void setTargetHint(float pixels);
+    // Maior entrada que o próximo detect() pode usar num frame deste tamanho
+    // (ou num recorte dele), já contando a troca de tamanho pendente
+    cv::Size upcomingInputSize(const cv::Size& frameSize) const;
+    std::string backendName() const { return backend->name(); }
+    const DetectorTimings& lastTimings() const { return timings; }
     
 private:
-    cv::dnn::Net net;
+    static constexpr int kNativeInputSize = 416;
+    static constexpr float kMinTargetPixels = 40.0f; // lado do alvo na entrada da rede
+    static constexpr int kSwitchFrames = 5;
+    
+    std::unique_ptr<InferenceBackend> backend;
+    std::vector<cv::Mat> outputs;
+    DetectorTimings timings;
     float confidenceThreshold;
     float nmsThreshold;
+    int maxDetections;
     std::vector<std::string> classNames;
     
+    // Pré-processamento persistente por tamanho de entrada (sem alocação por frame)
+    struct InputSlot {
+        int size = 0;
+        cv::Mat canvas;     // BGR redimensionado (HxWx3 uchar)
+        cv::Mat blob;       // Tensor de entrada (1x3xHxW float)
+        cv::Size frameSize; // Geometria abaixo vale para este frame
+        LetterboxInfo info;
+        double costMs = 0;  // média móvel de preprocess + forward (0 = sem medida)
+        bool supported = true;
+    };
+    std::vector<InputSlot> inputSlots;
+    int currentSlot;
+    int defaultSlot;
+    int inputWidth, inputHeight;
+    bool letterbox;
+    cv::Mat batchBlob;  // Tensor de entrada em lote (Nx3xHxW float)
+    bool batchSupported; // Falso quando o modelo foi exportado com batch fixo
+    
+    // Escolha da entrada por frame
+    double latencyBudgetMs;
+    float targetHintPx;
+    int pendingSlot;    // candidato a troca (histerese)
+    int pendingFrames;
+    
+    // Pós-processamento com buffers reutilizados entre frames
+    struct Candidate {
+        cv::Rect2f box;
+        float score;
+        int classId;
+    };
+    std::vector<int> survivors;
+    std::vector<Candidate> candidates;
+    std::vector<uchar> suppressed;
+    
+    LetterboxInfo preprocess(const cv::Mat& frame, float* dst);
+    void selectSlot(int wanted);
+    int chooseSlot(const cv::Size& frameSize, float targetPx) const;
+    double estimatedCost(int slot) const;
+    void activateSlot(int slot);
+    void scanConfidences(const float* conf, int count, float threshold);
+    
     std::vector<Detection> parseDetections(
-        const std::vector<cv::Mat>& outputs,
-        const cv::Size& frameSize
+        const cv::Mat& output,
+        int batchIndex,
+        const LetterboxInfo& info
     );
 };
 
@@ -0,0 +1,434 @@
+// Análise offline de vídeo gravado: o arquivo é dividido em segmentos,
+// decodificados e detectados em paralelo (um YOLODetector por worker), e
+// os resultados são costurados em ordem. Cada segmento começa 'overlap'
+// frames antes para aquecer o MultiObjectTracker; nesses frames as trilhas
+// locais são casadas por IoU com as do segmento anterior, mantendo os IDs
+// globais contínuos. Saída por frame em CSV e/ou JSON.
+
+#include "YOLODetector.h"
+#include "MultiObjectTracker.h"
+#include "BenchStats.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QThread>
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <map>
+#include <tuple>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+using BenchStats::summarize;
+
+float iou(const cv::Rect& a, const cv::Rect& b) {
+    float inter = (float)(a & b).area();
+    float uni = (float)(a.area() + b.area()) - inter;
+    return uni > 0 ? inter / uni : 0.0f;
+}
+
+struct FrameResult {
+    int index = 0;
+    std::vector<Detection> detections;
+};
+
+// Intervalo de frames de um segmento: [begin, end) é a saída; os frames
+// [warmupBegin, begin) só aquecem o rastreador e servem para a costura
+struct Segment {
+    int warmupBegin = 0;
+    int begin = 0;
+    int end = 0;
+    std::vector<FrameResult> warmup;
+    std::vector<FrameResult> frames;
+    std::vector<double> decodeMs;
+    std::vector<double> detectMs;
+    bool seekFailed = false;
+};
+
+// Posiciona a captura em 'frame'. O seek do FFmpeg pára no keyframe mais
+// próximo e nem sempre informa a posição exata: completa com grab()
+bool seekTo(cv::VideoCapture& cap, const QString& path, int frame) {
+    if (frame > 0) cap.set(cv::CAP_PROP_POS_FRAMES, frame);
+    int position = (int)cap.get(cv::CAP_PROP_POS_FRAMES);
+    if (position > frame) {
+        // Passou do ponto: reabre e avança desde o início
+        cap.open(path.toStdString());
+        position = 0;
+    }
+    for (; position < frame; position++) {
+        if (!cap.grab()) return false;
+    }
+    return true;
+}
+
+class SegmentWorker {
+public:
+    SegmentWorker(std::unique_ptr<YOLODetector> detector, const QString& path, int stride, int batch,
+                  float conf)
+        : detector(std::move(detector)), path(path), stride(stride), batch(batch), conf(conf) {}
+
+    void process(Segment& segment) {
+        cv::VideoCapture cap(path.toStdString());
+        if (!cap.isOpened() || !seekTo(cap, path, segment.warmupBegin)) {
+            segment.seekFailed = true;
+            return;
+        }
+
+        MultiObjectTracker tracker;
+        tracker.high_thresh = std::max(conf, tracker.low_thresh);
+        pending.clear();
+        pendingIndex.clear();
+
+        for (int index = segment.warmupBegin; index < segment.end; index++) {
+            // Frames fora da amostragem: só grab(), sem decodificar
+            if (index % stride != 0) {
+                if (!cap.grab()) break;
+                continue;
+            }
+            // Mat novo a cada frame: o lote guarda os anteriores
+            cv::Mat frame;
+            auto t0 = Clock::now();
+            if (!cap.read(frame)) break;
+            segment.decodeMs.push_back(elapsedMs(t0));
+
+            pending.push_back(frame);
+            pendingIndex.push_back(index);
+            if ((int)pending.size() >= batch) flush(segment, tracker);
+        }
+        flush(segment, tracker);
+    }
+
+private:
+    // Detecção (em lote quando batch > 1) e rastreio, sempre em ordem
+    void flush(Segment& segment, MultiObjectTracker& tracker) {
+        if (pending.empty()) return;
+
+        auto t0 = Clock::now();
+        std::vector<std::vector<Detection>> results;
+        if (pending.size() == 1) {
+            results.push_back(detector->detect(pending[0]));
+        } else {
+            results = detector->detectBatch(pending);
+        }
+        double perFrame = elapsedMs(t0) / pending.size();
+
+        for (size_t i = 0; i < pending.size(); i++) {
+            FrameResult result;
+            result.index = pendingIndex[i];
+            // Auditoria: abaixo de --conf só entram caixas de trilhas confirmadas
+            for (Detection& det : tracker.update(results[i])) {
+                if (det.trackId >= 0 || det.confidence >= conf) result.detections.push_back(std::move(det));
+            }
+            segment.detectMs.push_back(perFrame);
+            (result.index < segment.begin ? segment.warmup : segment.frames).push_back(std::move(result));
+        }
+        pending.clear();
+        pendingIndex.clear();
+    }
+
+    std::unique_ptr<YOLODetector> detector;
+    QString path;
+    int stride;
+    int batch;
+    float conf;
+    std::vector<cv::Mat> pending;
+    std::vector<int> pendingIndex;
+};
+
+// Reescreve os IDs locais do segmento com IDs globais. Os frames de
+// aquecimento são os mesmos que encerram o segmento anterior: cada par
+// (local, global) com IoU >= minIou ganha um voto; os pares mais votados
+// são aceitos sem repetir IDs, e trilhas sem par ganham IDs novos.
+void stitch(Segment& segment, const Segment* previous, float minIou, int& nextGlobalId) {
+    std::map<std::pair<int, int>, int> votes;
+    if (previous) {
+        std::map<int, const FrameResult*> tail;
+        for (const auto& frame : previous->frames) tail[frame.index] = &frame;
+
+        for (const auto& frame : segment.warmup) {
+            auto it = tail.find(frame.index);
+            if (it == tail.end()) continue;
+            for (const auto& det : frame.detections) {
+                if (det.trackId < 0) continue;
+                const Detection* best = nullptr;
+                float bestIou = minIou;
+                for (const auto& other : it->second->detections) {
+                    float overlap = iou(det.bbox, other.bbox);
+                    if (other.trackId >= 0 && overlap >= bestIou) {
+                        best = &other;
+                        bestIou = overlap;
+                    }
+                }
+                if (best) votes[{det.trackId, best->trackId}]++;
+            }
+        }
+    }
+
+    std::vector<std::tuple<int, int, int>> ranked; // votos, local, global
+    for (const auto& [ids, count] : votes) ranked.emplace_back(count, ids.first, ids.second);
+    std::sort(ranked.rbegin(), ranked.rend());
+
+    std::map<int, int> mapping;
+    std::map<int, bool> globalTaken;
+    for (const auto& [count, local, global] : ranked) {
+        if (mapping.count(local) || globalTaken[global]) continue;
+        mapping[local] = global;
+        globalTaken[global] = true;
+    }
+
+    for (auto& frame : segment.frames) {
+        for (auto& det : frame.detections) {
+            if (det.trackId < 0) continue;
+            auto it = mapping.find(det.trackId);
+            if (it == mapping.end()) it = mapping.emplace(det.trackId, nextGlobalId++).first;
+            det.trackId = it->second;
+        }
+    }
+}
+
+struct TrackSummary {
+    int firstFrame = 0;
+    int lastFrame = 0;
+    int frames = 0;
+};
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ptz_batch");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Análise offline de vídeo gravado: detecções e trilhas por frame");
+    parser.addHelpOption();
+    parser.addPositionalArgument("video", "Arquivo de vídeo");
+    parser.addOptions({
+        {"model", "Modelo ONNX", "path", "yolov8n.onnx"},
+        {"backend", "Backend de inferência (opencv/onnxruntime/openvino)", "name", "opencv"},
+        {"workers", "Workers em paralelo (0 = núcleos da máquina)", "n", "0"},
+        {"threads", "Threads do backend por worker", "n", "1"},
+        {"conf", "Confiança mínima", "value", "0.5"},
+        {"letterbox", "Pré-processamento com letterbox"},
+        {"batch", "Frames por forward em cada worker", "n", "1"},
+        {"stride", "Analisa 1 a cada N frames", "n", "1"},
+        {"segment", "Duração de cada segmento", "s", "60"},
+        {"overlap", "Frames de aquecimento do rastreador antes de cada segmento", "n", "45"},
+        {"stitch-iou", "IoU mínimo para casar trilhas entre segmentos", "value", "0.5"},
+        {"csv", "Grava as detecções por frame em CSV", "path"},
+        {"json", "Grava as detecções por frame e as trilhas em JSON", "path"},
+        {"output", "Grava o resumo neste arquivo em vez da saída padrão", "path"},
+    });
+    parser.process(app);
+
+    if (parser.positionalArguments().isEmpty()) {
+        parser.showHelp(1);
+    }
+    QString path = parser.positionalArguments().first();
+
+    cv::VideoCapture probe(path.toStdString());
+    if (!probe.isOpened()) {
+        QTextStream(stderr) << "Falha ao abrir " << path << "\n";
+        return 1;
+    }
+    double fps = probe.get(cv::CAP_PROP_FPS);
+    if (fps <= 0) fps = 30.0;
+    int frameCount = (int)probe.get(cv::CAP_PROP_FRAME_COUNT);
+    probe.release();
+
+    int stride = std::max(1, parser.value("stride").toInt());
+    int overlap = std::max(0, parser.value("overlap").toInt()) * stride;
+    int segmentFrames = std::max(stride, (int)std::lround(parser.value("segment").toDouble() * fps) / stride * stride);
+
+    // Contagem desconhecida (alguns contêineres): um segmento só, até o EOF
+    std::vector<Segment> segments;
+    for (int begin = 0; frameCount <= 0 ? begin == 0 : begin < frameCount; begin += segmentFrames) {
+        Segment segment;
+        segment.begin = begin;
+        segment.warmupBegin = std::max(0, begin - overlap);
+        segment.end = frameCount <= 0 ? INT_MAX : std::min(frameCount, begin + segmentFrames);
+        segments.push_back(std::move(segment));
+    }
+    // O último segmento vai até o EOF: CAP_PROP_FRAME_COUNT é estimado
+    segments.back().end = INT_MAX;
+
+    float conf = parser.value("conf").toFloat();
+    int workerCount = parser.value("workers").toInt();
+    if (workerCount <= 0) workerCount = QThread::idealThreadCount();
+    workerCount = std::clamp(workerCount, 1, (int)segments.size());
+
+    BackendConfig backendConfig;
+    backendConfig.type = parser.value("backend").toStdString();
+    backendConfig.threads = parser.value("threads").toInt();
+
+    // Detectores carregados antes de disparar os workers: erro de modelo sai cedo
+    std::vector<std::unique_ptr<SegmentWorker>> workers;
+    std::string backendName;
+    try {
+        for (int i = 0; i < workerCount; i++) {
+            // O detector entrega as caixas fracas; --conf vale depois da associação
+            auto detector = std::make_unique<YOLODetector>(parser.value("model").toStdString(),
+                                                           std::min(conf, MultiObjectTracker().low_thresh),
+                                                           backendConfig);
+            detector->setLetterbox(parser.isSet("letterbox"));
+            backendName = detector->backendName();
+            workers.push_back(std::make_unique<SegmentWorker>(
+                std::move(detector), path, stride, std::max(1, parser.value("batch").toInt()), conf));
+        }
+    } catch (const std::exception& e) {
+        QTextStream(stderr) << "Falha ao carregar o modelo: " << e.what() << "\n";
+        return 1;
+    }
+
+    // Fila de segmentos: cada worker pega o próximo índice livre
+    std::atomic<int> nextSegment(0);
+    std::atomic<int> doneSegments(0);
+    std::vector<QThread*> threads;
+    auto start = Clock::now();
+    for (auto& worker : workers) {
+        threads.push_back(QThread::create([&, w = worker.get()]() {
+            for (int i = nextSegment++; i < (int)segments.size(); i = nextSegment++) {
+                w->process(segments[i]);
+                QTextStream(stderr) << "\r" << ++doneSegments << "/" << segments.size() << " segmentos" << Qt::flush;
+            }
+        }));
+        threads.back()->start();
+    }
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    QTextStream(stderr) << "\n";
+
+    // Costura em ordem: IDs globais contínuos entre segmentos
+    int nextGlobalId = 0;
+    int seekFailures = 0;
+    for (size_t i = 0; i < segments.size(); i++) {
+        if (segments[i].seekFailed) seekFailures++;
+        stitch(segments[i], i > 0 ? &segments[i - 1] : nullptr,
+               parser.value("stitch-iou").toFloat(), nextGlobalId);
+    }
+
+    std::unique_ptr<QFile> csvFile;
+    QTextStream csv;
+    if (parser.isSet("csv")) {
+        csvFile = std::make_unique<QFile>(parser.value("csv"));
+        if (!csvFile->open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QTextStream(stderr) << "Falha ao gravar " << parser.value("csv") << "\n";
+            return 1;
+        }
+        csv.setDevice(csvFile.get());
+        csv << "frame,time_s,track_id,class_id,confidence,x,y,w,h\n";
+    }
+
+    bool writeJson = parser.isSet("json");
+    QJsonArray frameArray;
+    std::map<int, TrackSummary> tracks;
+    std::vector<double> decodeMs, detectMs;
+    long long analyzed = 0, detectionTotal = 0;
+    int lastFrame = -1;
+    for (const auto& segment : segments) {
+        decodeMs.insert(decodeMs.end(), segment.decodeMs.begin(), segment.decodeMs.end());
+        detectMs.insert(detectMs.end(), segment.detectMs.begin(), segment.detectMs.end());
+        for (const auto& frame : segment.frames) {
+            analyzed++;
+            lastFrame = frame.index;
+            detectionTotal += (long long)frame.detections.size();
+            if (frame.detections.empty()) continue;
+
+            double t = frame.index / fps;
+            QJsonArray detArray;
+            for (const auto& det : frame.detections) {
+                if (csvFile) {
+                    csv << frame.index << ',' << QString::number(t, 'f', 3) << ',' << det.trackId << ','
+                        << det.classId << ',' << QString::number(det.confidence, 'f', 3) << ','
+                        << det.bbox.x << ',' << det.bbox.y << ',' << det.bbox.width << ',' << det.bbox.height << '\n';
+                }
+                if (writeJson) {
+                    detArray.append(QJsonObject{
+                        {"track_id", det.trackId}, {"class_id", det.classId},
+                        {"confidence", det.confidence},
+                        {"box", QJsonArray{det.bbox.x, det.bbox.y, det.bbox.width, det.bbox.height}},
+                    });
+                }
+                if (det.trackId >= 0) {
+                    TrackSummary& track = tracks[det.trackId];
+                    if (track.frames++ == 0) track.firstFrame = frame.index;
+                    track.lastFrame = frame.index;
+                }
+            }
+            if (writeJson) {
+                frameArray.append(QJsonObject{{"frame", frame.index}, {"time_s", t}, {"detections", detArray}});
+            }
+        }
+    }
+
+    QJsonObject result;
+    result["video"] = path;
+    result["model"] = parser.value("model");
+    result["backend"] = QString::fromStdString(backendName);
+    result["workers"] = workerCount;
+    result["segments"] = (int)segments.size();
+    result["seek_failures"] = seekFailures;
+    result["fps"] = fps;
+    result["stride"] = stride;
+    result["frames_analyzed"] = analyzed;
+    result["video_seconds"] = (lastFrame + 1) / fps;
+    result["wall_seconds"] = wallSeconds;
+    result["speedup"] = wallSeconds > 0 ? (lastFrame + 1) / fps / wallSeconds : 0.0;
+    result["detections_per_frame"] = analyzed > 0 ? (double)detectionTotal / analyzed : 0.0;
+    result["tracks"] = (int)tracks.size();
+    QJsonObject stages;
+    stages["decode"] = summarize(decodeMs);
+    stages["detect"] = summarize(detectMs);
+    result["stages"] = stages;
+
+    if (writeJson) {
+        QJsonArray trackArray;
+        for (const auto& [id, track] : tracks) {
+            trackArray.append(QJsonObject{
+                {"track_id", id}, {"first_frame", track.firstFrame},
+                {"last_frame", track.lastFrame}, {"frames", track.frames},
+                {"duration_s", (track.lastFrame - track.firstFrame) / fps},
+            });
+        }
+        QJsonObject full = result;
+        full["frames"] = frameArray;
+        full["track_list"] = trackArray;
+        QFile file(parser.value("json"));
+        if (!file.open(QIODevice::WriteOnly)) {
+            QTextStream(stderr) << "Falha ao gravar " << parser.value("json") << "\n";
+            return 1;
+        }
+        file.write(QJsonDocument(full).toJson(QJsonDocument::Indented));
+    }
+
+    QByteArray summary = QJsonDocument(result).toJson(QJsonDocument::Indented);
+    if (parser.isSet("output")) {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly)) {
+            QTextStream(stderr) << "Falha ao gravar " << parser.value("output") << "\n";
+            return 1;
+        }
+        file.write(summary);
+    } else {
+        QTextStream(stdout) << summary;
+    }
+
+    return analyzed > 0 ? 0 : 1;
+}
@@ -0,0 +1,700 @@
+// Benchmark headless do pipeline: vídeo/imagens -> YOLODetector -> TrackingController.
+// Não precisa de webcam, janela Qt nem porta serial; imprime o resultado em JSON.
+// Com --sim a fonte vira uma VirtualPTZCamera comandada pelo controle (malha
+// fechada) e o JSON inclui tempo de acomodação, overshoot e perda do alvo.
+// Com --replay a fonte é uma sessão gravada pelo SessionRecorder: as
+// detecções gravadas passam de novo pelo TrackingController e cada passo é
+// comparado com o comando e o estado originais.
+// Com --streams N, N câmeras leem a fonte em paralelo e dividem um
+// InferenceService: mede a vazão e a latência da inferência em lote.
+
+#include "YOLODetector.h"
+#include "InferenceService.h"
+#include "TrackingController.h"
+#include "MultiObjectTracker.h"
+#include "VirtualPTZCamera.h"
+#include "ViscaProtocol.h"
+#include "MotionGate.h"
+#include "SessionReader.h"
+#include "BenchStats.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QThread>
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+using BenchStats::summarize;
+
+// Fonte de frames: arquivo de vídeo ou diretório de imagens
+class FrameReader {
+public:
+    bool open(const QString& source) {
+        if (QFileInfo(source).isDir()) {
+            std::vector<cv::String> all;
+            cv::glob(source.toStdString() + "/*", all, false);
+            for (const auto& f : all) {
+                QString ext = QFileInfo(QString::fromStdString(f)).suffix().toLower();
+                if (ext == "jpg" || ext == "jpeg" || ext == "png" || ext == "bmp") {
+                    files.push_back(f);
+                }
+            }
+            std::sort(files.begin(), files.end());
+            return !files.empty();
+        }
+        return cap.open(source.toStdString());
+    }
+
+    bool read(cv::Mat& frame) {
+        if (!files.empty()) {
+            if (next >= files.size()) return false;
+            frame = cv::imread(files[next++], cv::IMREAD_COLOR);
+            return !frame.empty();
+        }
+        return cap.read(frame);
+    }
+
+    double nominalFps() const {
+        double fps = files.empty() ? cap.get(cv::CAP_PROP_FPS) : 0.0;
+        return fps > 0 ? fps : 30.0;
+    }
+
+private:
+    cv::VideoCapture cap;
+    std::vector<cv::String> files;
+    size_t next = 0;
+};
+
+// Métricas de malha fechada a partir do erro normalizado do alvo
+class ClosedLoopMetrics {
+public:
+    ClosedLoopMetrics(double band, int holdFrames) : band(band), holdFrames(holdFrames) {}
+
+    // Tamanho do alvo relativo ao alvo do zoom automático (1 = ideal)
+    void addSize(double ratio) {
+        if (ratio <= 0) return;
+        double logErr = std::log(ratio);
+        sizeSumSq += logErr * logErr;
+        sizeFrames++;
+    }
+
+    // Troca de alvo: a trava passa direto de uma trilha para outra
+    void addLock(int trackId) {
+        if (trackId >= 0 && lastLock >= 0 && trackId != lastLock) switches++;
+        if (trackId >= 0) lastLock = trackId;
+    }
+
+    void add(double t, bool valid, double errX, double errY) {
+        if (!acquired) {
+            if (!valid) return;
+            acquired = true;
+            t0 = t;
+            e0x = errX;
+            e0y = errY;
+        }
+
+        frames++;
+        if (!valid) {
+            lostFrames++;
+            inBand = 0;
+            return;
+        }
+
+        double err = std::sqrt(errX * errX + errY * errY);
+        sumSq += err * err;
+        validFrames++;
+
+        // Overshoot: excursão para o lado oposto ao erro inicial
+        if (std::abs(e0x) > band) overshootX = std::max(overshootX, -errX * sign(e0x) / std::abs(e0x));
+        if (std::abs(e0y) > band) overshootY = std::max(overshootY, -errY * sign(e0y) / std::abs(e0y));
+
+        if (err <= band) {
+            if (inBand++ == 0) bandEntry = t;
+            if (inBand == holdFrames && settlingTime < 0) settlingTime = bandEntry - t0;
+        } else {
+            inBand = 0;
+        }
+    }
+
+    QJsonObject toJson() const {
+        QJsonObject obj;
+        obj["acquired"] = acquired;
+        obj["acquisition_s"] = acquired ? t0 : -1.0;
+        obj["settling_time_s"] = settlingTime;
+        obj["overshoot_pct"] = 100.0 * std::max(overshootX, overshootY);
+        obj["target_loss_rate"] = frames > 0 ? (double)lostFrames / frames : 0.0;
+        obj["rms_error"] = validFrames > 0 ? std::sqrt(sumSq / validFrames) : 0.0;
+        obj["target_switches"] = switches;
+        // Erro RMS do tamanho em escala log: 0.1 ~ 10% maior/menor que o alvo
+        obj["size_rms_log_error"] = sizeFrames > 0 ? std::sqrt(sizeSumSq / sizeFrames) : 0.0;
+        obj["settle_band"] = band;
+        return obj;
+    }
+
+private:
+    static double sign(double v) { return v < 0 ? -1.0 : 1.0; }
+
+    double band;
+    int holdFrames;
+    bool acquired = false;
+    double t0 = 0, e0x = 0, e0y = 0;
+    double overshootX = 0, overshootY = 0;
+    double settlingTime = -1, bandEntry = 0;
+    double sumSq = 0;
+    double sizeSumSq = 0;
+    long long sizeFrames = 0;
+    int inBand = 0;
+    int lastLock = -1, switches = 0;
+    long long frames = 0, lostFrames = 0, validFrames = 0;
+};
+
+bool writeResult(const QJsonObject& result, const QString& output) {
+    QByteArray json = QJsonDocument(result).toJson(QJsonDocument::Indented);
+    if (output.isEmpty()) {
+        QTextStream(stdout) << json;
+        return true;
+    }
+    QFile file(output);
+    if (!file.open(QIODevice::WriteOnly)) {
+        QTextStream(stderr) << "Falha ao gravar " << output << "\n";
+        return false;
+    }
+    file.write(json);
+    return true;
+}
+
+// Maior diferença absoluta entre o estado gravado e o do replay
+double stateDeviation(const ControllerState& a, const ControllerState& b) {
+    const float ControllerState::* fields[] = {
+        &ControllerState::integral_x, &ControllerState::integral_y,
+        &ControllerState::prev_err_x, &ControllerState::prev_err_y,
+        &ControllerState::filtered_derivative_x, &ControllerState::filtered_derivative_y,
+        &ControllerState::prev_ptz_speed_x, &ControllerState::prev_ptz_speed_y,
+        &ControllerState::last_nx, &ControllerState::last_ny, &ControllerState::last_nz,
+        &ControllerState::cam_gain_x, &ControllerState::cam_gain_y,
+    };
+    double deviation = 0;
+    for (auto field : fields) {
+        deviation = std::max(deviation, (double)std::abs(a.*field - b.*field));
+    }
+    if (a.lost_frames != b.lost_frames || a.locked_id != b.locked_id ||
+        a.target_valid != b.target_valid || a.manual_mode != b.manual_mode) {
+        deviation = INFINITY;
+    }
+    return deviation;
+}
+
+// Replay determinístico de uma sessão: mesma ordem de chamadas ao
+// controle (reset/manual/observe/step), sem esperar o relógio
+int runReplay(const QString& path, const QCommandLineParser& parser) {
+    SessionReader session;
+    if (!session.open(path)) {
+        QTextStream(stderr) << "Sessão inválida: " << path << "\n";
+        return 1;
+    }
+
+    double tolerance = parser.value("replay-tolerance").toDouble();
+    bool decodeFrames = parser.isSet("replay-frames");
+    TrackingController controller;
+    std::vector<double> stepMs, frameMs;
+    long long steps = 0, observations = 0, frames = 0, viscaCommands = 0, mismatches = 0;
+    double firstDivergence = -1, maxDeviation = 0, t0 = -1;
+
+    SessionReader::Chunk chunk;
+    Session::ObserveRecord observe;
+    Session::StepRecord step;
+    Session::FrameRecord frame;
+    Session::ManualRecord manual;
+    auto replayStart = Clock::now();
+    while (session.next(chunk)) {
+        if (t0 < 0) t0 = chunk.t;
+        switch (chunk.type) {
+        case Session::ChunkType::Reset:
+            controller.reset();
+            break;
+        case Session::ChunkType::Manual:
+            if (SessionReader::parse(chunk, manual)) controller.setManualTarget(manual.x, manual.y);
+            break;
+        case Session::ChunkType::Observe:
+            if (SessionReader::parse(chunk, observe)) {
+                controller.observe(observe.frameSize, observe.detections, chunk.t);
+                observations++;
+            }
+            break;
+        case Session::ChunkType::Step: {
+            if (!SessionReader::parse(chunk, step)) break;
+            controller.latency_compensation = step.latencyCompensation;
+            controller.auto_zoom = step.autoZoom;
+            controller.actuation_delay = step.actuationDelay;
+            controller.zoom_factor = step.zoomFactor;
+
+            auto t1 = Clock::now();
+            PTZCommand cmd = controller.step(chunk.t, step.dt, step.autoTracking);
+            stepMs.push_back(elapsedMs(t1));
+            steps++;
+
+            double deviation = stateDeviation(controller.state(), step.state);
+            bool commandDiffers = cmd.send != step.command.send || cmd.pan != step.command.pan ||
+                                  cmd.tilt != step.command.tilt || cmd.zoom != step.command.zoom;
+            if (std::isfinite(deviation)) maxDeviation = std::max(maxDeviation, deviation);
+            if (commandDiffers || deviation > tolerance) {
+                if (mismatches++ == 0) firstDivergence = chunk.t - t0;
+            }
+            break;
+        }
+        case Session::ChunkType::Frame:
+            frames++;
+            if (decodeFrames && SessionReader::parse(chunk, frame)) {
+                auto t1 = Clock::now();
+                SessionReader::decodeFrame(frame);
+                frameMs.push_back(elapsedMs(t1));
+            }
+            break;
+        case Session::ChunkType::Visca:
+            viscaCommands++;
+            break;
+        default:
+            break; // Tipo desconhecido (versão mais nova): ignora
+        }
+    }
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - replayStart).count();
+
+    QJsonObject result;
+    result["replay"] = path;
+    result["session_seconds"] = t0 >= 0 ? chunk.t - t0 : 0.0;
+    result["wall_seconds"] = wallSeconds;
+    result["truncated"] = session.truncated();
+    result["frames"] = frames;
+    result["observations"] = observations;
+    result["steps"] = steps;
+    result["visca_commands"] = viscaCommands;
+    result["mismatches"] = mismatches;
+    result["first_divergence_s"] = firstDivergence;
+    result["max_state_deviation"] = maxDeviation;
+    QJsonObject stages;
+    stages["step"] = summarize(stepMs);
+    if (decodeFrames) stages["frame_decode"] = summarize(frameMs);
+    result["stages"] = stages;
+
+    if (!writeResult(result, parser.value("output"))) return 1;
+    return steps > 0 && mismatches == 0 ? 0 : 1;
+}
+
+// Várias câmeras num host: cada stream lê a fonte na sua thread e manda os
+// frames para um InferenceService comum, que junta tudo em forwards em lote
+int runStreams(const QString& source, const QCommandLineParser& parser,
+               const BackendConfig& backendConfig) {
+    int streams = parser.value("streams").toInt();
+    MultiObjectTracker defaults;
+    std::shared_ptr<InferenceService> service;
+    try {
+        service = std::make_shared<InferenceService>(parser.value("model").toStdString(),
+                                                     defaults.low_thresh, streams,
+                                                     parser.value("batch-window").toInt(),
+                                                     backendConfig);
+    } catch (const std::exception& e) {
+        QTextStream(stderr) << "Falha ao carregar o modelo: " << e.what() << "\n";
+        return 1;
+    }
+    service->setLetterbox(parser.isSet("letterbox"));
+    std::vector<int> inputSizes;
+    for (const QString& s : parser.value("input-sizes").split(',', Qt::SkipEmptyParts)) {
+        inputSizes.push_back(s.trimmed().toInt());
+    }
+    service->setInputSizes(inputSizes);
+
+    double budget = parser.value("budget").toDouble();
+    double rate = parser.value("rate").toDouble();
+    int maxFrames = parser.value("frames").toInt();
+    int warmup = parser.value("warmup").toInt();
+    float conf = parser.value("conf").toFloat();
+
+    struct StreamStats {
+        bool opened = false;
+        std::vector<double> inferMs;
+        std::map<int, int> batchCounts;
+        std::map<int, int> inputCounts;
+        long long detections = 0;
+    };
+    std::vector<StreamStats> stats(streams);
+    std::atomic<int> warming{streams};
+    std::vector<QThread*> threads;
+    for (int s = 0; s < streams; s++) {
+        threads.push_back(QThread::create([&, s] {
+            StreamStats& st = stats[s];
+            FrameReader reader;
+            st.opened = reader.open(source);
+            MultiObjectTracker tracker;
+            tracker.high_thresh = std::max(conf, tracker.low_thresh);
+            service->registerClient();
+
+            auto period = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(rate > 0 ? 1.0 / rate : 0.0));
+            auto nextFrame = Clock::now();
+            cv::Mat frame;
+            int frameIndex = 0;
+            while (st.opened && (maxFrames <= 0 || frameIndex < warmup + maxFrames)) {
+                if (rate > 0) {
+                    std::this_thread::sleep_until(nextFrame);
+                    nextFrame += period;
+                }
+                if (!reader.read(frame)) break;
+                if (frameIndex == warmup) {
+                    // Todos medem juntos: lotes completos desde o primeiro frame medido
+                    warming--;
+                    while (warming.load() > 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    nextFrame = Clock::now();
+                }
+
+                auto t0 = Clock::now();
+                InferenceService::Result result = service->submit(frame, 0.0f, budget).get();
+                double infer = elapsedMs(t0);
+                auto detections = tracker.update(result.detections);
+
+                if (frameIndex >= warmup) {
+                    st.inferMs.push_back(infer);
+                    st.batchCounts[result.batchSize]++;
+                    st.inputCounts[result.inputSize]++;
+                    st.detections += (long long)detections.size();
+                }
+                frameIndex++;
+            }
+            if (frameIndex <= warmup) warming--;
+            service->unregisterClient();
+        }));
+    }
+
+    for (QThread* thread : threads) thread->start();
+    // O relógio começa quando todos os streams saíram do aquecimento
+    while (warming.load() > 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    auto benchStart = Clock::now();
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - benchStart).count();
+
+    std::vector<double> inferMs;
+    std::map<int, int> batchCounts, inputCounts;
+    long long detectionTotal = 0;
+    for (const StreamStats& st : stats) {
+        if (!st.opened) {
+            QTextStream(stderr) << "Falha ao abrir " << source << "\n";
+            return 1;
+        }
+        inferMs.insert(inferMs.end(), st.inferMs.begin(), st.inferMs.end());
+        for (const auto& [size, count] : st.batchCounts) batchCounts[size] += count;
+        for (const auto& [size, count] : st.inputCounts) inputCounts[size] += count;
+        detectionTotal += st.detections;
+    }
+
+    int measured = (int)inferMs.size();
+    QJsonObject result;
+    result["source"] = source;
+    result["model"] = parser.value("model");
+    result["backend"] = QString::fromStdString(service->backendName());
+    result["threads"] = backendConfig.threads;
+    result["streams"] = streams;
+    result["batch_window_ms"] = parser.value("batch-window").toInt();
+    result["rate_fps"] = rate;
+    result["frames"] = measured;
+    result["wall_seconds"] = wallSeconds;
+    result["throughput_fps"] = wallSeconds > 0 ? measured / wallSeconds : 0.0;
+    result["detections_per_frame"] = measured > 0 ? (double)detectionTotal / measured : 0.0;
+    QJsonObject stages;
+    stages["inference"] = summarize(inferMs); // pedido -> resultado, com a espera do lote
+    result["stages"] = stages;
+    QJsonObject batches, inputs;
+    for (const auto& [size, count] : batchCounts) batches[QString::number(size)] = count;
+    for (const auto& [size, count] : inputCounts) inputs[QString::number(size)] = count;
+    result["batch_sizes"] = batches;
+    result["input_sizes"] = inputs;
+    result["budget_ms"] = budget;
+
+    if (!writeResult(result, parser.value("output"))) return 1;
+    return measured > 0 ? 0 : 1;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ptz_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark headless do PTZ Tracker (latência por estágio em JSON)");
+    parser.addHelpOption();
+    parser.addPositionalArgument("source", "Arquivo de vídeo, diretório de imagens ou sessão (--replay)");
+    parser.addOptions({
+        {"model", "Modelo ONNX", "path", "yolov8n.onnx"},
+        {"backend", "Backend de inferência (opencv/onnxruntime/openvino)", "name", "opencv"},
+        {"threads", "Threads do backend (0 = padrão)", "n", "0"},
+        {"no-graph-opt", "Desliga a otimização de grafo do backend"},
+        {"conf", "Confiança mínima", "value", "0.5"},
+        {"letterbox", "Pré-processamento com letterbox"},
+        {"input-sizes", "Entradas da rede permitidas, separadas por vírgula", "list", "416"},
+        {"budget", "Orçamento de preprocess + forward para a entrada adaptativa (0 = fixa)", "ms", "0"},
+        {"motion-gate", "Pula o detector em cena parada sem trilha ativa"},
+        {"rate", "Taxa fixa de entrada em FPS (0 = o mais rápido possível)", "fps", "0"},
+        {"frames", "Limite de frames medidos (0 = todos)", "n", "0"},
+        {"warmup", "Frames de aquecimento descartados", "n", "5"},
+        {"output", "Grava o JSON neste arquivo em vez da saída padrão", "path"},
+        {"sim", "Malha fechada: a fonte (panorama/vídeo) alimenta uma câmera PTZ virtual"},
+        {"sim-latency", "Latência do motor simulado", "ms", "80"},
+        {"sim-pan", "Pan inicial da câmera simulada", "graus", "0"},
+        {"sim-tilt", "Tilt inicial da câmera simulada", "graus", "0"},
+        {"sim-zoom", "Zoom inicial da câmera simulada", "x", "1"},
+        {"no-compensation", "Desliga a compensação de latência do controle"},
+        {"control-rate", "Taxa do laço de controle na simulação", "hz", "50"},
+        {"settle-band", "Erro normalizado máximo para considerar o alvo centrado", "value", "0.05"},
+        {"auto-zoom", "Zoom automático pelo tamanho do alvo na simulação"},
+        {"zoom-target", "Tamanho normalizado do alvo mantido pelo zoom automático", "nz", "0.2"},
+        {"replay", "A fonte é uma sessão gravada: refaz o controle e compara com a gravação"},
+        {"replay-tolerance", "Diferença máxima aceita no estado do controle", "value", "1e-4"},
+        {"replay-frames", "Decodifica também os frames gravados (mede o custo)"},
+        {"streams", "Câmeras simuladas lendo a fonte em paralelo, com inferência em lote compartilhada", "n", "0"},
+        {"batch-window", "Espera máxima para completar o lote com --streams", "ms", "5"},
+    });
+    parser.process(app);
+
+    if (parser.positionalArguments().isEmpty()) {
+        parser.showHelp(1);
+    }
+    QString source = parser.positionalArguments().first();
+    if (parser.isSet("replay")) {
+        return runReplay(source, parser);
+    }
+
+    BackendConfig backendConfig;
+    backendConfig.type = parser.value("backend").toStdString();
+    backendConfig.threads = parser.value("threads").toInt();
+    backendConfig.optimizeGraph = !parser.isSet("no-graph-opt");
+    if (parser.value("streams").toInt() > 0) {
+        return runStreams(source, parser, backendConfig);
+    }
+
+    bool simMode = parser.isSet("sim");
+    FrameReader reader;
+    std::shared_ptr<VirtualPTZCamera> sim;
+    if (simMode) {
+        SimConfig simConfig;
+        simConfig.latencyMs = parser.value("sim-latency").toDouble();
+        sim = std::make_shared<VirtualPTZCamera>(simConfig);
+        if (!sim->open(source.toStdString())) {
+            QTextStream(stderr) << "Falha ao abrir " << source << "\n";
+            return 1;
+        }
+        VirtualPTZCamera::State initial;
+        initial.pan = parser.value("sim-pan").toDouble();
+        initial.tilt = parser.value("sim-tilt").toDouble();
+        initial.zoom = parser.value("sim-zoom").toDouble();
+        sim->setState(initial);
+    } else if (!reader.open(source)) {
+        QTextStream(stderr) << "Falha ao abrir " << source << "\n";
+        return 1;
+    }
+
+    // Como no app: o detector entrega as caixas fracas e o limiar --conf
+    // é aplicado pelo rastreador depois da associação
+    MultiObjectTracker tracker;
+    tracker.high_thresh = std::max(parser.value("conf").toFloat(), tracker.low_thresh);
+
+    std::unique_ptr<YOLODetector> detector;
+    try {
+        detector = std::make_unique<YOLODetector>(parser.value("model").toStdString(),
+                                                  tracker.low_thresh,
+                                                  backendConfig);
+    } catch (const std::exception& e) {
+        QTextStream(stderr) << "Falha ao carregar o modelo: " << e.what() << "\n";
+        return 1;
+    }
+    detector->setLetterbox(parser.isSet("letterbox"));
+    std::vector<int> inputSizes;
+    for (const QString& s : parser.value("input-sizes").split(',', Qt::SkipEmptyParts)) {
+        inputSizes.push_back(s.trimmed().toInt());
+    }
+    detector->setInputSizes(inputSizes);
+    detector->setLatencyBudget(parser.value("budget").toDouble());
+
+    TrackingController controller;
+    // Sem câmera real a imagem não gira com os comandos: só a simulação
+    // usa a compensação de latência (com o atraso conhecido do motor)
+    controller.latency_compensation = simMode && !parser.isSet("no-compensation");
+    controller.actuation_delay = (float)(parser.value("sim-latency").toDouble() / 1000.0);
+    controller.auto_zoom = simMode && parser.isSet("auto-zoom");
+    controller.zoom_target = parser.value("zoom-target").toFloat();
+
+    double rate = parser.value("rate").toDouble();
+    int maxFrames = parser.value("frames").toInt();
+    int warmup = parser.value("warmup").toInt();
+    // dt nominal: o controle fica determinístico independente do host
+    float dt = 1.0f / (float)(rate > 0 ? rate : reader.nominalFps());
+    if (simMode && maxFrames <= 0) {
+        maxFrames = (int)std::lround(20.0 / dt); // Panorama não acaba: 20 s simulados
+    }
+    int controlTicks = std::max(1, (int)std::lround(dt * parser.value("control-rate").toDouble()));
+    float tickDt = dt / controlTicks;
+    ClosedLoopMetrics metrics(parser.value("settle-band").toDouble(), (int)std::lround(0.5 / dt));
+
+    std::vector<double> decodeMs, preprocessMs, forwardMs, postprocessMs, controlMs, totalMs;
+    long long detectionTotal = 0;
+    int frameIndex = 0;
+    int lastZoom = 0;
+    std::map<int, int> inputCounts; // frames por entrada da rede
+    MotionGate motionGate;
+    bool useGate = parser.isSet("motion-gate");
+    int gatedFrames = 0;
+
+    auto nextFrame = Clock::now();
+    auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(rate > 0 ? 1.0 / rate : 0.0));
+    Clock::time_point benchStart;
+
+    cv::Mat frame;
+    while (maxFrames <= 0 || frameIndex < warmup + maxFrames) {
+        if (rate > 0) {
+            std::this_thread::sleep_until(nextFrame);
+            nextFrame += period;
+        }
+        if (frameIndex == warmup) {
+            benchStart = Clock::now();
+        }
+
+        auto t0 = Clock::now();
+        // Na simulação o tempo avança nos passos de controle abaixo
+        bool ok = simMode ? sim->read(frame, 0.0) : reader.read(frame);
+        if (!ok) break;
+        double decode = elapsedMs(t0);
+
+        // Entrada adaptativa: tamanho do alvo em pixels do frame
+        float hintX, hintY, hintZ;
+        bool hintValid = controller.targetHint(hintX, hintY, hintZ);
+        detector->setTargetHint(hintValid ? hintZ * std::hypot((float)frame.cols, (float)frame.rows) : 0.0f);
+
+        // Cena parada sem trilha: o detector não roda (keep-alive em tempo nominal)
+        auto frameClock = Clock::time_point(std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(frameIndex * (double)dt)));
+        bool gated = useGate && !motionGate.shouldDetect(frame, tracker.hasTracks(), frameClock);
+        std::vector<Detection> detections;
+        DetectorTimings timings;
+        if (!gated) {
+            detections = detector->detect(frame);
+            timings = detector->lastTimings();
+        }
+
+        auto t1 = Clock::now();
+        detections = tracker.update(detections);
+        if (simMode) {
+            // Controle em taxa fixa entre frames, como na CaptureEngine
+            double frameTime = frameIndex * (double)dt;
+            // A simulação conhece o zoom real (como uma inquiry à câmera)
+            controller.zoom_factor = (float)sim->state().zoom;
+            controller.observe(frame.size(), detections, frameTime);
+            for (int i = 0; i < controlTicks; i++) {
+                controller.zoom_factor = (float)sim->state().zoom;
+                PTZCommand cmd = controller.step(frameTime + i * tickDt, tickDt, true);
+                if (cmd.send) {
+                    sim->handleCommand(Visca::panTiltDrive(cmd.pan, cmd.tilt));
+                }
+                if (cmd.zoom != lastZoom) {
+                    sim->handleCommand(Visca::zoomDrive(cmd.zoom));
+                    lastZoom = cmd.zoom;
+                }
+                sim->advance(tickDt);
+            }
+        } else {
+            controller.update(frame.size(), detections, dt, true);
+        }
+        double control = elapsedMs(t1);
+        
+        if (simMode) {
+            float nx, ny, nz;
+            bool valid = controller.targetHint(nx, ny, nz);
+            metrics.add(frameIndex * dt, valid, nx - 0.5, ny - 0.5);
+            if (valid) metrics.addSize(nz / controller.zoom_target);
+            metrics.addLock(controller.lockedTrackId());
+        }
+
+        double total = elapsedMs(t0);
+
+        if (frameIndex >= warmup) {
+            decodeMs.push_back(decode);
+            preprocessMs.push_back(timings.preprocessMs);
+            forwardMs.push_back(timings.forwardMs);
+            postprocessMs.push_back(timings.decodeMs);
+            controlMs.push_back(control);
+            totalMs.push_back(total);
+            detectionTotal += (long long)detections.size();
+            if (gated) {
+                gatedFrames++;
+            } else {
+                inputCounts[timings.inputSize]++;
+            }
+        }
+        frameIndex++;
+    }
+
+    int measured = (int)totalMs.size();
+    double wallSeconds = measured > 0
+        ? std::chrono::duration<double>(Clock::now() - benchStart).count() : 0.0;
+
+    QJsonObject stages;
+    stages["decode"] = summarize(decodeMs);
+    stages["preprocess"] = summarize(preprocessMs);
+    stages["forward"] = summarize(forwardMs);
+    stages["postprocess"] = summarize(postprocessMs);
+    stages["control"] = summarize(controlMs);
+    stages["total"] = summarize(totalMs);
+
+    QJsonObject result;
+    result["source"] = source;
+    result["model"] = parser.value("model");
+    result["backend"] = QString::fromStdString(detector->backendName());
+    result["threads"] = backendConfig.threads;
+    result["letterbox"] = parser.isSet("letterbox");
+    result["rate_fps"] = rate;
+    result["frames"] = measured;
+    result["wall_seconds"] = wallSeconds;
+    result["throughput_fps"] = wallSeconds > 0 ? measured / wallSeconds : 0.0;
+    result["detections_per_frame"] = measured > 0 ? (double)detectionTotal / measured : 0.0;
+    result["stages"] = stages;
+    QJsonObject inputs;
+    for (const auto& [size, count] : inputCounts) {
+        inputs[QString::number(size)] = count;
+    }
+    result["input_sizes"] = inputs;
+    result["budget_ms"] = parser.value("budget").toDouble();
+    result["motion_gate"] = useGate;
+    result["gated_frames"] = gatedFrames;
+    if (simMode) {
+        QJsonObject simResult = metrics.toJson();
+        simResult["latency_ms"] = parser.value("sim-latency").toDouble();
+        simResult["control_rate_hz"] = controlTicks / dt;
+        simResult["latency_compensation"] = controller.latency_compensation;
+        simResult["auto_zoom"] = controller.auto_zoom;
+        simResult["final_zoom"] = sim->state().zoom;
+        result["closed_loop"] = simResult;
+    }
+
+    if (!writeResult(result, parser.value("output"))) return 1;
+
+    return measured > 0 ? 0 : 1;
+}
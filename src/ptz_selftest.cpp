@@ -0,0 +1,302 @@
+// Autoteste headless das partes sem hardware (opcional, PTZ_BUILD_SELFTESTS).
+// "udp" põe o UdpTransport contra um respondedor VISCA over IP em 127.0.0.1
+// e confere numeração de sequência, retransmissão e ressincronização 0F 01.
+// "logring" estressa o LogRing com 4 produtores e 1 consumidor; para caçar
+// corridas, compile com -fsanitize=thread.
+
+#include "UdpTransport.h"
+#include "LogRing.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QHostAddress>
+#include <QThread>
+#include <QTextStream>
+#include <QUdpSocket>
+#include <QtEndian>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+int failures = 0;
+
+void check(bool ok, const QString &what) {
+    QTextStream(stdout) << (ok ? "ok    " : "FALHA ") << what << "\n";
+    if (!ok) failures++;
+}
+
+// Câmera VISCA over IP mínima: responde ACK + Completion a cada comando e,
+// sob pedido, ignora o próximo comando ou devolve erro de sequência 0F 01
+class LoopbackResponder {
+public:
+    enum Fault { None, DropNext, SequenceErrorNext };
+
+    struct Packet {
+        quint16 type;
+        quint32 seq;
+        QByteArray payload;
+    };
+
+    bool start() {
+        thread = QThread::create([this] { run(); });
+        thread->start();
+        while (port.load() == 0 && !failed.load()) QThread::msleep(1);
+        return !failed.load();
+    }
+
+    void stop() {
+        stopping = true;
+        thread->wait();
+        delete thread;
+    }
+
+    void inject(Fault f) { fault = f; }
+    quint16 localPort() const { return port.load(); }
+
+    std::vector<Packet> received() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return packets;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        packets.clear();
+    }
+
+private:
+    void run() {
+        // O socket vive na thread que o usa
+        QUdpSocket socket;
+        if (!socket.bind(QHostAddress(QHostAddress::LocalHost), 0)) {
+            failed = true;
+            return;
+        }
+        port = socket.localPort();
+
+        while (!stopping.load()) {
+            if (!socket.waitForReadyRead(20)) continue;
+            while (socket.hasPendingDatagrams()) {
+                QByteArray datagram((int)socket.pendingDatagramSize(), 0);
+                QHostAddress from;
+                quint16 fromPort = 0;
+                socket.readDatagram(datagram.data(), datagram.size(), &from, &fromPort);
+                if (datagram.size() < 8) continue;
+
+                Packet p;
+                p.type = qFromBigEndian<quint16>(datagram.constData());
+                p.seq = qFromBigEndian<quint32>(datagram.constData() + 4);
+                p.payload = datagram.mid(8);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    packets.push_back(p);
+                }
+
+                if (p.type == 0x0200) {
+                    reply(socket, from, fromPort, 0x0201, QByteArray(1, (char)0x01), p.seq);
+                    continue;
+                }
+                if (p.type != 0x0100) continue;
+
+                Fault f = fault.exchange(None);
+                if (f == DropNext) continue;
+                if (f == SequenceErrorNext) {
+                    reply(socket, from, fromPort, 0x0201, QByteArray::fromHex("0F01"), p.seq);
+                    continue;
+                }
+                reply(socket, from, fromPort, 0x0111, QByteArray::fromHex("9041FF"), p.seq);
+                reply(socket, from, fromPort, 0x0111, QByteArray::fromHex("9051FF"), p.seq);
+            }
+        }
+    }
+
+    static void reply(QUdpSocket &socket, const QHostAddress &to, quint16 toPort,
+                      quint16 type, const QByteArray &payload, quint32 seq) {
+        QByteArray datagram(8, 0);
+        qToBigEndian<quint16>(type, datagram.data());
+        qToBigEndian<quint16>((quint16)payload.size(), datagram.data() + 2);
+        qToBigEndian<quint32>(seq, datagram.data() + 4);
+        datagram.append(payload);
+        socket.writeDatagram(datagram, to, toPort);
+    }
+
+    QThread *thread = nullptr;
+    std::atomic<quint16> port{0};
+    std::atomic<bool> failed{false};
+    std::atomic<bool> stopping{false};
+    std::atomic<Fault> fault{None};
+    std::mutex mutex;
+    std::vector<Packet> packets;
+};
+
+std::vector<quint32> commandSeqs(const std::vector<LoopbackResponder::Packet> &packets) {
+    std::vector<quint32> seqs;
+    for (const auto &p : packets) {
+        if (p.type == 0x0100) seqs.push_back(p.seq);
+    }
+    return seqs;
+}
+
+// Espera a Completion (90 5x FF) do comando em andamento
+bool waitCompletion(UdpTransport &transport, int timeoutMs) {
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    QByteArray bytes;
+    while (true) {
+        int remaining = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - Clock::now()).count();
+        if (remaining <= 0) return false;
+        if (!transport.waitForReply(bytes, remaining)) return false;
+        if (bytes.size() >= 2 && ((unsigned char)bytes[1] & 0xF0) == 0x50) return true;
+    }
+}
+
+void runUdp() {
+    LoopbackResponder responder;
+    if (!responder.start()) {
+        check(false, "respondedor UDP em 127.0.0.1");
+        return;
+    }
+
+    UdpTransport transport("127.0.0.1", responder.localPort());
+    check(transport.open(), "open() em " + transport.description());
+
+    // Pan-tilt stop: pacote qualquer com resposta ACK + Completion
+    const QByteArray command = QByteArray::fromHex("8101060118180303FF");
+
+    // 1) Sequência: reset em 0 e comandos numerados 1, 2, 3
+    bool allAnswered = true;
+    for (int i = 0; i < 3; i++) {
+        transport.send(command);
+        allAnswered = waitCompletion(transport, 500) && allAnswered;
+    }
+    auto packets = responder.received();
+    check(!packets.empty() && packets.front().type == 0x0200 && packets.front().seq == 0
+              && packets.front().payload == QByteArray(1, (char)0x01),
+          "open() envia reset de sequência (0200, seq 0, payload 01)");
+    check(allAnswered, "três comandos respondidos");
+    check(commandSeqs(packets) == std::vector<quint32>({1, 2, 3}), "comandos numerados 1, 2, 3");
+
+    // 2) Retransmissão: o primeiro envio se perde, o reenvio usa a mesma sequência
+    responder.clear();
+    responder.inject(LoopbackResponder::DropNext);
+    auto sent = Clock::now();
+    transport.send(command);
+    bool recovered = waitCompletion(transport, 500);
+    double waited = elapsedMs(sent);
+    check(recovered, "comando perdido é respondido após retransmissão");
+    check(commandSeqs(responder.received()) == std::vector<quint32>({4, 4}),
+          "retransmissão repete a sequência 4");
+    check(waited >= 55.0,
+          QString("retransmissão após ~60 ms (%1 ms)").arg(waited, 0, 'f', 1));
+
+    // 3) Ressincronização: 0F 01 zera a sequência e o comando volta como seq 1
+    responder.clear();
+    responder.inject(LoopbackResponder::SequenceErrorNext);
+    transport.send(command);
+    bool resynced = waitCompletion(transport, 500);
+    packets = responder.received();
+    bool resetSeen = false;
+    for (const auto &p : packets) {
+        if (p.type == 0x0200 && p.seq == 0) resetSeen = true;
+    }
+    check(resynced, "comando respondido após 0F 01");
+    check(resetSeen, "0F 01 dispara reset de sequência");
+    check(commandSeqs(packets) == std::vector<quint32>({5, 1}), "comando reenviado como seq 1");
+
+    // E a numeração segue a partir do reset
+    responder.clear();
+    transport.send(command);
+    waitCompletion(transport, 500);
+    check(commandSeqs(responder.received()) == std::vector<quint32>({2}), "próximo comando segue com seq 2");
+
+    transport.close();
+    responder.stop();
+}
+
+void runLogRing() {
+    const int producers = 4;
+    const int perProducer = 200000;
+    LogRing ring(1024); // Pequeno de propósito: força anel cheio e descarte
+
+    std::atomic<long long> pushed{0};
+    std::atomic<int> running{producers};
+    std::vector<QThread*> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.push_back(QThread::create([&ring, &pushed, &running, p, perProducer] {
+            for (int i = 0; i < perProducer; i++) {
+                LogEntry entry;
+                entry.level = p;
+                entry.timeMs = i;
+                if (i % 64 == 0) entry.text = QString::number(i); // Exercita a posse do QString
+                if (ring.push(std::move(entry))) pushed++;
+            }
+            running--;
+        }));
+    }
+    for (QThread* thread : threads) thread->start();
+
+    // Consumidor: a ordem por produtor tem que ser preservada
+    long long popped = 0;
+    std::vector<qint64> last(producers, -1);
+    bool ordered = true, textOk = true;
+    LogEntry entry;
+    while (true) {
+        bool finished = running.load() == 0; // Lido antes do pop: o que sobrar é drenado abaixo
+        while (ring.pop(entry)) {
+            popped++;
+            if (entry.timeMs <= last[entry.level]) ordered = false;
+            last[entry.level] = entry.timeMs;
+            if (entry.timeMs % 64 == 0 && entry.text != QString::number(entry.timeMs)) textOk = false;
+        }
+        if (finished) break;
+    }
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    uint64_t dropped = ring.takeDropped();
+
+    check(popped == pushed.load(), QString("tudo o que entrou saiu (%1 de %2)").arg(popped).arg(pushed.load()));
+    check(pushed.load() + (long long)dropped == (long long)producers * perProducer,
+          QString("descartes contados (%1)").arg(dropped));
+    check(ordered, "ordem preservada por produtor");
+    check(textOk, "textos íntegros");
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ptz_selftest");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Autoteste headless do PTZ Tracker (sem câmera nem GUI)");
+    parser.addHelpOption();
+    parser.addPositionalArgument("suite", "udp, logring (padrão: todas)");
+    parser.process(app);
+
+    QStringList suites = parser.positionalArguments();
+    if (suites.isEmpty()) suites = {"udp", "logring"};
+    for (const QString &suite : suites) {
+        if (suite == "udp") {
+            runUdp();
+        } else if (suite == "logring") {
+            runLogRing();
+        } else {
+            QTextStream(stderr) << "Suíte desconhecida: " << suite << "\n";
+            return 2;
+        }
+    }
+
+    QTextStream(stdout) << (failures == 0 ? "Tudo ok" : QString("%1 falha(s)").arg(failures)) << "\n";
+    return failures == 0 ? 0 : 1;
+}